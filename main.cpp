@@ -12,24 +12,113 @@
  * preciseness that C offers with the added libraries and functions that C++
  * provides.
  *
+ * Build with: g++ -O2 -pthread main.cpp
+ *
  * @author: Marcos Davila
  * @date: 12/10/2012
  */
 
-// The maximum amount of pages that this process will be using
-#define MAX_NUM_PAGES 1024
+// The maximum amount of pages that this process will be using, unless set with
+// --pages
+#define DEFAULT_NUM_PAGES 1024
+
+// The total number of free frames the process has to work with, unless set
+// with --frames
+#define DEFAULT_PAGE_FRAMES 48
 
-// The total number of free frames the process has to work with
-#define MAX_PAGE_FRAMES 48
+// The number of references in a generated reference string, unless set with
+// --references
+#define DEFAULT_POOL_SIZE 500
 
-// The number of processes a CPU will work on.
-#define PROC_POOL_SIZE 500
+// Tables at least this large (in bytes) are asked for in huge pages
+#define HUGE_PAGE_SIZE (2 << 20)
 
 // Valid / invalid bits signifying if an entry in a table points to
 // a valid memory address.
 #define INVALID_BIT 0
 #define VALID_BIT 1
 
+// LRU-K: the number of references of history kept per page, the window (in
+// references) inside which repeated references count as one correlated burst,
+// and how long the history of an evicted page is retained
+#define LRU_K 2
+#define LRU_K_CORRELATED_PERIOD 4
+#define LRU_K_RETAINED_PERIOD 4096
+
+// S3-FIFO: the share of the frames (in percent) given to the small
+// probationary queue, and the number of hits a page has to exceed while in the
+// small queue to be promoted into the main queue instead of being evicted
+#define S3FIFO_SMALL_PERCENT 10
+#define S3FIFO_PROMOTE_THRESHOLD 1
+
+// W-TinyLFU: the share of the frames (in percent) given to the LRU window, the
+// share of the main region kept as its protected segment, and how many
+// sketch increments per frame pass before every counter is halved
+#define WTINYLFU_WINDOW_PERCENT 1
+#define WTINYLFU_PROTECTED_PERCENT 80
+#define WTINYLFU_SAMPLE_FACTOR 10
+
+// Working set: the window tau (in references) a page stays in the working set
+// after its last use, and how often the resident set size is sampled
+#define WS_TAU 50
+#define WS_SAMPLE_INTERVAL 50
+
+// Page-fault frequency: the replacement policy PFF manages unless another is
+// asked for as PFF-<policy>, the frames it starts with, the fewest frames it
+// ever shrinks to, and the inter-fault intervals (in references) below which a
+// frame is added and above which one is taken away
+#define PFF_BASE "LRU"
+#define PFF_INITIAL_FRAMES 8
+#define PFF_MIN_FRAMES 2
+#define PFF_LOWER_INTERVAL 4
+#define PFF_UPPER_INTERVAL 16
+
+// Multi-Queue: the number of LRU queues, how long (in references) a page may
+// go unreferenced before it drops a queue, and the size of the history of
+// evicted pages as a multiple of the frames
+#define MQ_QUEUES 8
+#define MQ_LIFE_TIME 128
+#define MQ_QOUT_FACTOR 4
+
+// Sampled eviction: how many resident frames are sampled per eviction
+#define SAMPLED_K 5
+
+// NRU: how often (in references) the referenced bits are cleared
+#define NRU_CLEAR_INTERVAL 32
+
+// The share of references (in percent) in the reference string that are
+// writes; writes are marked by a trailing 'w' on the page number
+#define WRITE_PERCENT 25
+
+// The most threads the simulator will run at once
+#define MAX_THREADS 64
+
+// Fused runs: how many references of the trace each engine is fed at a time,
+// small enough that a block stays in L1 while every engine walks it
+#define FUSED_BLOCK 2048
+
+// How many references apart checkpoints are written by default
+#define CHECKPOINT_INTERVAL 1000000
+
+// Follow mode: how often (in milliseconds) the reference string is checked
+// for references appended to it
+#define FOLLOW_POLL_MS 200
+
+// Server mode: the most references one batch may carry
+#define SERVE_MAX_BATCH 65536
+
+// Counter Stacks: how many references apart counters are started, how close (in
+// percent) a counter must come to the next older one to be pruned, and how many
+// bits of the hash pick one of a counter's HyperLogLog registers
+#define COUNTER_STACKS_INTERVAL 16
+#define COUNTER_STACKS_PRUNE_PERCENT 2
+#define HYPERLOGLOG_BITS 10
+
+// AET: how many pages the sampled model tracks at most. A few hundred pages
+// leave too few samples on skewed traces; a few thousand, as SHARDS uses, keep
+// the estimate within a few percent.
+#define AET_SAMPLE_BUDGET 4096
+
 #include <stdio.h>
 #include <algorithm>
 #include <stdlib.h>
@@ -40,911 +129,5638 @@
 #include <vector>
 #include <ctype.h>
 #include <cstring>
+#include <queue>
+#include <functional>
+#include <stdint.h>
+#include <thread>
+#include <atomic>
+#include <map>
+#include <set>
+#include <mutex>
+#include <deque>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 using std::string;
 using std::ifstream;
-using std::cin;
 using std::cout;
 using std::endl;
 using std::vector;
 using std::transform;
-
-int isInMemory(int frame_table[MAX_PAGE_FRAMES][2], int page, int reference);
+using std::priority_queue;
+using std::greater;
+using std::thread;
+using std::atomic;
+using std::map;
+using std::mutex;
+using std::deque;
+using std::lock_guard;
+using std::istringstream;
+using std::ostringstream;
+using std::ofstream;
+
+int isInMemory(int frame_table[][2], int page, int reference);
+int parseReference(string referenceString, int &write);
+int pageInRange(int page, int &skipped);
+void reportSkipped(string filename, int skipped);
 string displayReferenceString();
-void displayPageTable(int page_table[MAX_NUM_PAGES][3], string type);
-void RAN(int page_table[MAX_NUM_PAGES][3], int frame_table[MAX_PAGE_FRAMES][2], vector<int> free_frame_list, string ref);
-void OPT(int page_table[MAX_NUM_PAGES][3], int frame_table[MAX_PAGE_FRAMES][2], vector<int> free_frame_list, string ref);
-int identifyPageToRemove(int frame_table[MAX_PAGE_FRAMES][2], vector<int> free_frame_list);
-void RU(int page_table[MAX_NUM_PAGES][3], int frame_table[MAX_PAGE_FRAMES][2], vector<int> free_frame_list, string type);
-void FIFO(int page_table[MAX_NUM_PAGES][3], int frame_table[MAX_PAGE_FRAMES][2], vector<int> free_frame_list);
+void displayPageTable(int page_table[][3], string type);
+void OPT(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, string ref);
+int identifyPageToRemove(int frame_table[][2], const vector<int> &reference_string);
 void createReferenceString();
 
-// Global variables which keep track of user's preferences for output for all
-// page replacement algorithms
+// The sizes of the page table and the frame table, and the length of the
+// reference string to generate
+int max_num_pages = DEFAULT_NUM_PAGES;
+int max_page_frames = DEFAULT_PAGE_FRAMES;
+int proc_pool_size = DEFAULT_POOL_SIZE;
+
+// Whether to print the reference string and the page table after every fault
+// for all page replacement algorithms, set with --verbose
 int enableVerboseOutput = 0;
-string vb = "";
 
-int main(){
-	/*
-	 * Seed the random number generator and create the addresses for the process.
-	 * The addresses reference what parts of the program should be paged in and
-	 * out
-	 */
-	srand(time(NULL));
-	createReferenceString();
+// The seed of the reference string and of every random algorithm, and how many
+// seeds the random algorithms are run with
+uint64_t random_seed = 0;
+int monte_carlo_runs = 1;
 
-	/* A page table is needed to store the mapping between virtual addresses
-	 * and physical addresses. For this process, the maximum number of entries
-	 * in the page table is LAS_SIZE / PAGE_SIZE, or 2^23 / 2^3 = 2^20.
-	 * This should be reflected in the variable MAX_NUM_PAGES.
-	 *
-	 * The first entry contains the base address of each page in physical
-	 * memory. The second entry contains whether this offset is valid. On
-	 * algorithms that require it, the third position is auxiliary.
-	 */
-	int page_table[MAX_NUM_PAGES][3];
+// The reference string every algorithm reads
+string trace_filename = "reference_string.txt";
 
-	/*
-	 * A free frame list is necessary for knowing what frames in physical memory
-	 * are free so proper frames can be allocated as necessary. At the beginning,
-	 * all pages are available due to our use of demand paging.
-	 */
-	 vector<int> free_frame_list(MAX_PAGE_FRAMES);
+// Where fused runs save their engines every checkpoint_interval references,
+// and the checkpoint they resume from
+string checkpoint_filename = "";
+int checkpoint_interval = CHECKPOINT_INTERVAL;
+string resume_filename = "";
 
-	/*
-	 * A frame table is required to keep track of the allocation details of
-	 * physical memory. It keeps track of which frames are allocated, which
-	 * frames are available, how many total frames there are, and so on.
-	 *
-	 * The frame table has one entry for each physical page frame, indicating
-	 * whether the latter is free or allocated and, if it is allocated, to
-	 * which page of this process.
-	 *
-	 * The first column in the frame table designates what page is occupying
-	 * that entry (-1 is for entries that are not occupied). On
-	 * algorithms that require it, the second position is auxiliary.zz
-	 */
-	 int frame_table[MAX_PAGE_FRAMES][2];
+/*
+ * xoshiro256** by Blackman and Vigna: a small, fast generator whose whole state
+ * is four words, so every engine and every thread can own one and a run can be
+ * repeated exactly from its seed.
+ */
+struct Random {
+	uint64_t s[4];
 
-	/*
-	 * Set the initial data for all of the tables that each algorithm will
-	 * use. The page_table and frame_table should be initialized to invalid,
-	 * the free frame list should have all the possible frames (from 0 to
-	 * MAX_PAGE_FRAMES) listed in its vector.
-	 */
-	for (int i = 0; i < MAX_NUM_PAGES; i++){
-		page_table[i][0] = INVALID_BIT;
-		page_table[i][1] = INVALID_BIT;
-		page_table[i][2] = INVALID_BIT;
-	}
+	Random(uint64_t seed);
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; i++){
-		frame_table[i][0] = 0;
-		frame_table[i][1] = INVALID_BIT;
-	}
+	uint64_t next();
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; i++){
-		free_frame_list.push_back(i);
-	}
+	// A uniformly distributed number in [0, 1)
+	double uniform();
+};
 
-	 /*
-	  * Include the option for the user to print out the reference string and
-	  * the page table after every fault.
-	  */
-	string vb;
-	cout << "Do you want to enable verbose output? (Y/N)" << endl;
-	cin >> vb;
+/*
+ * The pages referenced by a reference string and whether each reference is a
+ * write, held in memory so that it can be shared by several runs
+ */
+struct Trace {
+	vector<int> pages;
+	vector<char> writes;
+};
 
-	transform(vb.begin(), vb.end(), vb.begin(), tolower);
+/*
+ * Zeroed memory for a page or frame table, sized at run time. Tables of a huge
+ * page or more are asked for in huge pages, which keeps lookups of pages
+ * scattered across a large table from missing the TLB; if none are reserved,
+ * transparent huge pages are requested instead.
+ */
+struct TableMemory {
+	int *data;
+	size_t bytes;
 
-	if (vb == "y" || vb == "yes"){
-		enableVerboseOutput = 1;
-	}
+	TableMemory(size_t ints);
+	~TableMemory();
 
-	// Create the a string to hold the number of page references and
-	// if desired by the user, print them to the screen
-	string ref = displayReferenceString();
+private:
+	TableMemory(const TableMemory &);
+	TableMemory &operator=(const TableMemory &);
+};
 
-	/*
-	 * Begin running simulations, starting with FIFO, then LRU, then
-	 * MRU, then OPT, then RAN, then RAN2
-	 */
-	FIFO(page_table, frame_table, free_frame_list);
+/*
+ * The state of engines flattened into bytes. The same checkpoint functions
+ * write state into a checkpoint that is saving and read it back from one that
+ * is loading, so saving and loading cannot drift apart. Reading past the end
+ * of the bytes marks the checkpoint failed instead of reading garbage.
+ */
+struct Checkpoint {
+	string bytes;
+	size_t position;
+	int loading;
+	int failed;
 
-	/*
-	 * Set the initial data for all of the tables that each algorithm will
-	 * use. The page_table and frame_table should be initialized to invalid,
-	 * the free frame list should have all the possible frames (from 0 to
-	 * MAX_PAGE_FRAMES) listed in its vector.
-	 */
-	for (int i = 0; i < MAX_NUM_PAGES; i++){
-		page_table[i][0] = INVALID_BIT;
-		page_table[i][1] = INVALID_BIT;
-		page_table[i][2] = INVALID_BIT;
-	}
+	// A checkpoint to save into
+	Checkpoint() : position(0), loading(0), failed(0) {}
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; i++){
-		frame_table[i][0] = 0;
-		frame_table[i][1] = INVALID_BIT;
-	}
+	// A checkpoint to load from
+	Checkpoint(const string &bytes) : bytes(bytes), position(0), loading(1), failed(0) {}
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; i++){
-		free_frame_list.push_back(i);
-	}
+	void block(void *data, size_t size);
 
-	RU(page_table, frame_table, free_frame_list, "LRU");
+	// Plain values and fixed arrays of them
+	template<class T> void field(T &value) { block(&value, sizeof(value)); }
 
-	/*
-	 * Set the initial data for all of the tables that each algorithm will
-	 * use. The page_table and frame_table should be initialized to invalid,
-	 * the free frame list should have all the possible frames (from 0 to
-	 * MAX_PAGE_FRAMES) listed in its vector.
-	 */
-	for (int i = 0; i < MAX_NUM_PAGES; i++){
-		page_table[i][0] = INVALID_BIT;
-		page_table[i][1] = INVALID_BIT;
-		page_table[i][2] = INVALID_BIT;
-	}
+	template<class T> void field(vector<T> &values);
+	template<class T, class C, class P> void field(priority_queue<T, C, P> &queue);
+	void field(string &value);
+};
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; i++){
-		frame_table[i][0] = 0;
-		frame_table[i][1] = INVALID_BIT;
+template<class T> void Checkpoint::field(vector<T> &values){
+	uint64_t size = values.size();
+	field(size);
+
+	if (loading){
+		if (failed || size > bytes.size() - position){
+			failed = 1;
+			return;
+		}
+		values.resize(size);
 	}
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; i++){
-		free_frame_list.push_back(i);
+	if (size > 0){
+		block(&values[0], size * sizeof(T));
 	}
+}
 
-	RU(page_table, frame_table, free_frame_list, "MRU");
+template<class T, class C, class P> void Checkpoint::field(priority_queue<T, C, P> &queue){
+	// The heap array is a protected member, reached through a derived class
+	struct Heap : priority_queue<T, C, P> {
+		static C &container(priority_queue<T, C, P> &queue){ return queue.*(&Heap::c); }
+	};
 
-	/*
-	 * Set the initial data for all of the tables that each algorithm will
-	 * use. The page_table and frame_table should be initialized to invalid,
-	 * the free frame list should have all the possible frames (from 0 to
-	 * MAX_PAGE_FRAMES) listed in its vector.
-	 */
-	for (int i = 0; i < MAX_NUM_PAGES; i++){
-		page_table[i][0] = INVALID_BIT;
-		page_table[i][1] = INVALID_BIT;
-		page_table[i][2] = INVALID_BIT;
-	}
+	field(Heap::container(queue));
+}
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; i++){
-		frame_table[i][0] = 0;
-		frame_table[i][1] = INVALID_BIT;
-	}
+/*
+ * Common bookkeeping for the replacement engines that are driven one reference
+ * at a time. An engine works on the page table, frame table and free frame list
+ * it is handed exactly as the algorithms above do: a fault takes a frame from
+ * the free frame list while one is left and otherwise asks the policy for a
+ * victim. Subclasses only decide what a hit does, what loading a page does and
+ * which frame to give up.
+ */
+struct Engine {
+	string type;
+	int (*page_table)[3];
+	int (*frame_table)[2];
+	vector<int> free_frame_list;
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; i++){
-		free_frame_list.push_back(i);
-	}
+	// The number of frames the engine was allocated, the faults it has taken
+	// and its virtual time (the number of references it has seen)
+	int frames;
+	int fault_rate;
+	int time;
 
-	// Run the optimal page replacement algorithm as a benchmark
-	OPT(page_table, frame_table, free_frame_list, ref);
+	// Whether the reference being processed is a write
+	int writing;
 
-	/*
-	 * Set the initial data for all of the tables that each algorithm will
-	 * use. The page_table and frame_table should be initialized to invalid,
-	 * the free frame list should have all the possible frames (from 0 to
-	 * MAX_PAGE_FRAMES) listed in its vector.
-	 */
-	for (int i = 0; i < MAX_NUM_PAGES; i++){
-		page_table[i][0] = INVALID_BIT;
-		page_table[i][1] = INVALID_BIT;
-		page_table[i][2] = INVALID_BIT;
-	}
+	Engine(string type, int page_table[][3], int frame_table[][2], vector<int> free_frame_list);
+	virtual ~Engine(){}
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; i++){
-		frame_table[i][0] = 0;
-		frame_table[i][1] = INVALID_BIT;
-	}
+	// Processes one reference and returns 1 if it caused a page fault
+	virtual int reference(int page, int write = 0);
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; i++){
-		free_frame_list.push_back(i);
-	}
+	// Evicts the page chosen by the policy and returns the frame it occupied
+	int evict();
 
-	// Run a random page replacement algorithm to determine its effectiveness
-	// as compared to tried and true algorithms. This random replacement algorithm
-	// first tries the uniformly distributed method of random number generation
-	// and page replacement first
-	RAN(page_table, frame_table, free_frame_list, "RAN");
+	// Invalidates whatever page occupies a frame
+	void discard(int frame);
 
-	/*
-	 * Set the initial data for all of the tables that each algorithm will
-	 * use. The page_table and frame_table should be initialized to invalid,
-	 * the free frame list should have all the possible frames (from 0 to
-	 * MAX_PAGE_FRAMES) listed in its vector.
-	 */
-	for (int i = 0; i < MAX_NUM_PAGES; i++){
-		page_table[i][0] = INVALID_BIT;
-		page_table[i][1] = INVALID_BIT;
-		page_table[i][2] = INVALID_BIT;
-	}
+	// Tells the policy how many frames it now holds, for policies that size
+	// their queues as a share of the allocation
+	virtual void resize(int frames);
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; i++){
-		frame_table[i][0] = 0;
-		frame_table[i][1] = INVALID_BIT;
-	}
+	int isResident(int page);
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; i++){
-		free_frame_list.push_back(i);
-	}
+	// Prints the results of the run
+	virtual void report();
 
-    // This random replacement algorithm tries the pseudorandom method of
-	// random number generation and page replacement
-	RAN(page_table, frame_table, free_frame_list, "RAN2");
+	// Saves or loads the tables and the policy's state
+	void checkpoint(Checkpoint &c);
 
-	return 0;
-}
+	// Saves or loads everything but the tables, which an engine layered over
+	// another shares with it
+	virtual void checkpointState(Checkpoint &c);
 
-/*
- * Checks to see if the reference held in the frame table matches the
- * new reference. Useful for seeing if a page is already in memory or
- * if a different page needs to be replaced.
- */
-int isInMemory(int frame_table[MAX_PAGE_FRAMES][2], int page, int reference){
-	if (frame_table[page][0] == reference){
-		return 1;
-	} else {
-		return 0;
-	}
-}
+protected:
+	// Called on a page fault before a frame is taken for the page
+	virtual void fault(int page) {}
+
+	virtual void hit(int page, int frame) = 0;
+	virtual void load(int page, int frame) = 0;
+	virtual int victim() = 0;
+};
 
 /*
- * Displays the reference string in row order on the console to the user
+ * LRU-K keeps the times of the last K uncorrelated references to every page and
+ * evicts the page whose K-th most recent reference is oldest.
  */
-string displayReferenceString(){
-    string pageList;
-    string temp;
+struct LRUKEngine : Engine {
+	struct HeapEntry {
+		int kth;
+		int first;
+		int page;
+		int stamp;
+
+		bool operator>(const HeapEntry &other) const {
+			if (kth != other.kth) return kth > other.kth;
+			return first > other.first;
+		}
+	};
 
-	ifstream addresses;
-	addresses.open("reference_string.txt");
+	int k;
+	int correlated_period;
+	int retained_period;
 
-	 if (addresses.is_open()) {
-        while (!addresses.eof()) {
-            addresses >> temp;
-            pageList += temp + "\t";
-        }
-	 }
-	 addresses.close();
+	// hist[page * k + i] holds the time of the (i+1)-th most recent
+	// uncorrelated reference to the page and last[page] the time of its most
+	// recent reference, correlated or not. Both are kept after eviction, which
+	// makes them the retained history table.
+	vector<int> hist;
+	vector<int> last;
 
-	 if (enableVerboseOutput){
-		cout << "Reference strings (in row order):\n" << pageList << endl;
-	 }
+	// Resident pages ordered by backward K-distance. Entries are never removed
+	// in place; stamp[page] is bumped instead and stale entries are skipped.
+	priority_queue<HeapEntry, vector<HeapEntry>, greater<HeapEntry> > heap;
+	vector<int> stamp;
 
-	 return pageList;
-}
+	LRUKEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list,
+			int k, int correlated_period, int retained_period);
+
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void hit(int page, int frame);
+	void load(int page, int frame);
+	int victim();
+
+private:
+	void push(int page);
+	void rebuild();
+};
 
 /*
- * Display the page table after each page fault if it is requested by the user.
- * Depending on the algorithm, the output will be different.
+ * A fixed-capacity FIFO of page numbers. head and tail only ever grow and are
+ * masked into a power-of-two array, so a producer and a consumer never write
+ * the same field, which keeps the queue usable from lock-free code.
  */
-void displayPageTable(int page_table[MAX_NUM_PAGES][3], string type){
-	cout << "Page Replacement Algorithm: " << type << endl;
-	cout << "Page\t" << "Valid/Invalid Bit\t" << "Auxiliary\t" << endl;
+struct RingBuffer {
+	vector<int> slots;
+	unsigned int mask;
+	unsigned int head;
+	unsigned int tail;
 
-	if (type == "FIFO" || type == "RAN" || type == "OPT") {
-		for (int i = 0; i < MAX_NUM_PAGES; i++){
-			cout << page_table[i][0] << "\t" << page_table[i][1] << endl;
-		}
-	} else {
-		for (int i = 0; i < MAX_NUM_PAGES; i++){
-			cout << page_table[i][0] << "\t" << page_table[i][1] << "\t" << page_table[i][2] << endl;
-		}
-	}
-}
+	RingBuffer(int capacity);
+
+	void checkpoint(Checkpoint &c);
+
+	int size() const { return tail - head; }
+	void push(int page) { slots[tail++ & mask] = page; }
+	int pop() { return slots[head++ & mask]; }
+};
 
 /*
- * Implement a randomized version of the page replacement algorithm to gauge how effective a randomized algorithm
- * would be in regards to page replacement. This algorithm uses both pseudorandom numbers as well as a uniformly
- * distributed random number generation scheme to compare the effectiveness of both types of generations to each
- * other as well as to the other page replacement methods.
+ * S3-FIFO keeps new pages in a small probationary FIFO and pages that proved
+ * themselves in a main FIFO, and remembers recently evicted pages in a ghost
+ * FIFO so that they skip probation when they come back.
  */
-void RAN(int page_table[MAX_NUM_PAGES][3], int frame_table[MAX_PAGE_FRAMES][2], vector<int> free_frame_list, string ref){
-    // Start by reading in addresses that the program would access in sequential order from the file
-	ifstream addresses;
-	addresses.open("reference_string.txt");
+struct S3FIFOEngine : Engine {
+	RingBuffer small_fifo;
+	RingBuffer main_fifo;
+	RingBuffer ghost_fifo;
 
-	string referenceString;
+	int small_target;
+	int ghost_capacity;
 
-	int reference = 0;
-	int fault_rate = 0;
+	// ghost_stamp[page] is one past the ghost queue position the page was
+	// inserted at, or 0 if it was never inserted
+	vector<unsigned int> ghost_stamp;
 
-	/*
-	 * Continue reading from the file only if the file is open and not at the end of its input
-	 */
-	if (addresses.is_open()){
-		while (!addresses.eof()) {
-			addresses >> referenceString;
-			reference = atoi(referenceString.c_str());
+	S3FIFOEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list);
 
-			// If the reference to physical memory is invalid, we need to get a
-			// new page. Consult the free frame list to find a free frame on
-			// the backing store
-			if (page_table[reference][1] == INVALID_BIT){
-				int freeframe = 0;
+	void resize(int frames);
 
-				// If we have no more free frames to allocate, then all of the
-				// slots in the frame table must be occupied.
-				if (free_frame_list.size() == 0){
-					// No free frames are available, so we must generate a random
-					// page to replace using a scheme based on ref
-					if (ref == "RAN"){
-                        freeframe = (double) rand() / (RAND_MAX+1.0) * (MAX_PAGE_FRAMES);
-					} else {
-                        freeframe = rand() % MAX_PAGE_FRAMES;
-					}
-				} else {
-					// Pick a free frame from the top of the list
-					freeframe = free_frame_list.back();
+	void checkpointState(Checkpoint &c);
 
-					// Remove this page from the free frame list and decrease the size of the
-					// list by one.
-					free_frame_list.pop_back();
-				}
+protected:
+	void hit(int page, int frame);
+	void load(int page, int frame);
+	int victim();
 
-				// Update the tables
-				page_table[reference][0] = freeframe;
-				page_table[reference][1] = VALID_BIT;
+private:
+	int inGhost(int page);
+};
 
-				frame_table[freeframe][0] = reference;
-				fault_rate++;
+/*
+ * SIEVE keeps pages in insertion order with a visited bit and a hand that
+ * sweeps from the oldest towards the newest page looking for one that was not
+ * visited since the hand last passed it.
+ */
+struct SIEVEEngine : Engine {
+	// A doubly linked list over frame numbers, newest at head and oldest at
+	// tail; -1 ends the list
+	vector<int> prev;
+	vector<int> next;
+	int head;
+	int tail;
+	int hand;
 
-				// Check to see if the user desires output
-				if (enableVerboseOutput && vb != "never"){
-					cout << "Do you want to display the page table? (YES/NO/NEVER)" << endl;
-					cin >> vb;
+	SIEVEEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list);
 
-					transform(vb.begin(), vb.end(), vb.begin(), tolower);
+	void checkpointState(Checkpoint &c);
 
-					if (vb == "yes" || vb == "y"){
-						displayPageTable(page_table, ref);
-					}
-				}
-			} else if (!isInMemory(frame_table, page_table[reference][0], reference)){
-				// No free frames are available, so we must generate a random
-                // page to replace
-                int freeframe = 0;
-				if (ref == "RAN"){
-                        freeframe = (double) rand() / (RAND_MAX+1.0) * (MAX_PAGE_FRAMES);
-					} else {
-                        freeframe = rand() % MAX_PAGE_FRAMES;
-					}
+protected:
+	void hit(int page, int frame);
+	void load(int page, int frame);
+	int victim();
+};
 
-				// Mark the old page in the page table as invalid, place the new
-				// page into its location in the page table and then update
-				// both tables
-				int oldframe = page_table[reference][0];
-				int oldpage = frame_table[freeframe][0];
+/*
+ * Doubly linked lists threaded through per-frame prev/next arrays, most
+ * recently used at the head. Several lists share the arrays since a frame sits
+ * in at most one list at a time; list[frame] says which one, or -1 for none.
+ */
+struct FrameLists {
+	vector<int> prev;
+	vector<int> next;
+	vector<int> list;
+	vector<int> head;
+	vector<int> tail;
+	vector<int> size;
 
-				page_table[oldpage][1] = INVALID_BIT;
+	FrameLists(int lists, int frames);
 
-				page_table[reference][0] = freeframe;
-				page_table[reference][1] = VALID_BIT;
-				frame_table[freeframe][0] = reference;
+	void checkpoint(Checkpoint &c);
 
-				// Since we made one frame available, we must push it back onto the list
-				free_frame_list.push_back(oldframe);
-				fault_rate++;
+	void pushFront(int l, int frame);
+	void remove(int frame);
+};
 
-				// Check to see if the user desires output
-				if (enableVerboseOutput && vb != "never"){
-					cout << "Do you want to display the page table? (YES/NO/NEVER)" << endl;
-					cin >> vb;
+/*
+ * A count-min sketch of 4-bit counters packed sixteen to a 64-bit word, with a
+ * Bloom filter doorkeeper in front of it. It estimates how often each page was
+ * referenced recently in a few hundred bytes.
+ */
+struct FrequencySketch {
+	vector<uint64_t> table;
+	vector<uint64_t> doorkeeper;
+	int counter_bits;
+	int doorkeeper_mask;
+	int additions;
+	int sample_size;
+
+	FrequencySketch(int frames);
+
+	void resize(int frames);
+	void checkpoint(Checkpoint &c);
+
+	void increment(int page);
+	int estimate(int page);
+
+private:
+	int counter(unsigned int index) const;
+	void setCounter(unsigned int index, int count);
+	void indexes(int page, unsigned int index[4]);
+	int inDoorkeeper(int page, int add);
+	void halve();
+};
 
-					transform(vb.begin(), vb.end(), vb.begin(), tolower);
+/*
+ * W-TinyLFU puts new pages in a small LRU window and only lets a page leaving
+ * the window into the segmented LRU main region if the frequency sketch says it
+ * is referenced more often than the page it would displace.
+ */
+struct WTinyLFUEngine : Engine {
+	enum { WINDOW, PROBATION, PROTECTED };
 
-					if (vb == "yes" || vb == "y"){
-						displayPageTable(page_table, ref);
-					}
-				}
-			}
-		}
-	}
+	FrameLists lists;
+	FrequencySketch sketch;
+	int window_capacity;
+	int protected_capacity;
 
-	// Display the RAN fault rate
-	cout << ref << ": " << fault_rate << endl;
-	addresses.close();
-}
+	WTinyLFUEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list);
+
+	void resize(int frames);
 
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void hit(int page, int frame);
+	void load(int page, int frame);
+	int victim();
+};
 
 /*
- * Implement the optimal page replacement algorithm by first examining the input string of reference addresses and
- * constructing a table by which we would be able to infer the optimal page to replace at each point in the program.
- * Then, run the algorithm again on the same reference addresses using this table as a guide to determine what pages
- * to replace.
+ * Records how many frames a variable-allocation engine holds over time: a
+ * sample every interval references, plus the mean and peak over the run.
  */
+struct ResidentSetTrace {
+	int interval;
+	vector<int> samples;
+	long total;
+	int references;
+	int peak;
 
-void OPT(int page_table[MAX_NUM_PAGES][3], int frame_table[MAX_PAGE_FRAMES][2], vector<int> free_frame_list, string ref){
-	// Start by reading in addresses that the program would access in sequential order from the file
-	ifstream addresses, oracle;
-	oracle.open("reference_string.txt");
+	ResidentSetTrace(int interval);
 
-	string referenceString;
-	// Fill a vector with the reference strings so that they can be referenced later
-	// when we are trying to predict pages to remove
-	vector<int> reference_string;
-	for (int i = 0; i < PROC_POOL_SIZE; i++){
-		oracle >> referenceString;
-		reference_string.push_back(atoi(referenceString.c_str()));
-	}
+	void checkpoint(Checkpoint &c);
 
-	oracle.close();
-	addresses.open("reference_string.txt");
+	void record(int time, int resident);
+	void report(string type, string measure = "resident set");
+};
 
-	int reference = 0;
-	int fault_rate = 0;
-	int loops = 0;
+/*
+ * Denning's working set: a page stays resident for tau references after its
+ * last use and is then given back, so the number of frames held follows the
+ * locality of the program instead of being fixed.
+ */
+struct WSEngine : Engine {
+	FrameLists lists;
+	int tau;
+	ResidentSetTrace resident;
 
-	/*
-	 * Continue reading from the file only if the file is open and not at the end of its input
-	 */
-	if (addresses.is_open()){
-		while (!addresses.eof()) {
-			addresses >> referenceString;
-			reference = atoi(referenceString.c_str());
+	WSEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, int tau);
 
-			if (page_table[reference][1] == INVALID_BIT){
-				int freeframe = 0;
+	int reference(int page, int write = 0);
+	void report();
 
-				// If we have no more free frames to allocate, then all of the
-				// slots in the frame table must be occupied.
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void hit(int page, int frame);
+	void load(int page, int frame);
+	int victim();
+};
+
+/*
+ * WSClock approximates the working set with a clock hand and a referenced bit
+ * instead of keeping pages ordered by last use.
+ */
+struct WSClockEngine : Engine {
+	int tau;
+	int hand;
+
+	// WSClock replaces a stale page in place rather than giving its frame
+	// back, so the frames it holds only grow. What it reports instead is its
+	// working set: the resident pages referenced in the last tau references,
+	// counted as references come in and leave the window of the last tau.
+	ResidentSetTrace working_set;
+	vector<int> used_at;
+	vector<int> window;
+	int working;
+
+	// The resident page with the oldest last use seen by the latest sweep,
+	// evicted if a full pass freed nothing and no free frame is left
+	int oldest;
+
+	WSClockEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, int tau);
+
+	int reference(int page, int write = 0);
+	void report();
+
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void fault(int page);
+	void hit(int page, int frame);
+	void load(int page, int frame);
+	int victim();
+
+private:
+	void leaveWorkingSet(int frame);
+};
+
+/*
+ * Page-fault frequency allocation layered over any other engine: PFF decides
+ * how many frames the process holds and the engine underneath decides which
+ * pages occupy them. PFF's own free frame list is the pool of frames the
+ * process does not hold.
+ */
+struct PFFEngine : Engine {
+	Engine *base;
+	int allocation;
+	int last_fault;
+	ResidentSetTrace resident;
+
+	// The number of distinct pages referenced since the last fault, counted
+	// by stamping each page with the fault it was last referenced after
+	vector<int> referenced_after;
+	int distinct;
+
+	PFFEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, Engine *base);
+	~PFFEngine();
+
+	int reference(int page, int write = 0);
+	void report();
+
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void hit(int page, int frame) {}
+	void load(int page, int frame) {}
+	int victim();
+
+private:
+	void grow();
+	void shrink(int count);
+};
+
+Engine *createEngine(string type, int page_table[][3], int frame_table[][2], vector<int> free_frame_list,
+		const int *pages = NULL, int references = 0, uint64_t seed = random_seed);
+
+/*
+ * Not recently used: every resident page is in one of four classes by its
+ * referenced and modified bits, and the victim is a random page from the lowest
+ * class that has any.
+ */
+struct NRUEngine : Engine {
+	enum { REFERENCED = 2, MODIFIED = 1 };
+
+	// One bitmap of frames per class, so finding the lowest non-empty class
+	// and a random member of it only looks at a few words
+	vector<uint64_t> classes[4];
+	int clear_interval;
+	int writebacks;
+	Random random;
+
+	NRUEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, int clear_interval,
+			uint64_t seed);
+
+	int reference(int page, int write = 0);
+	void report();
+
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void hit(int page, int frame);
+	void load(int page, int frame);
+	int victim();
+
+private:
+	void setClass(int page, int frame, int bits);
+};
+
+/*
+ * The resident frames of an engine in no particular order, and where each frame
+ * sits in that order, so that a random resident frame is one draw away and
+ * frames come and go in constant time
+ */
+struct ResidentFrames {
+	vector<int> frames;
+	vector<int> position;
+
+	ResidentFrames();
+
+	void checkpoint(Checkpoint &c);
+
+	int size() const { return frames.size(); }
+	void insert(int frame);
+	void erase(int frame);
+};
+
+/*
+ * Random replacement: the victim is a resident frame picked at random, either
+ * by scaling a uniformly distributed number (RAN) or by taking a random number
+ * modulo the number of frames (RAN2).
+ */
+struct RANEngine : Engine {
+	Random random;
+	ResidentFrames resident;
+
+	RANEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, string type, uint64_t seed);
+
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void hit(int page, int frame) {}
+	void load(int page, int frame);
+	int victim();
+};
+
+/*
+ * CLOCK-Pro keeps hot pages, cold resident pages and recently evicted cold
+ * pages still in their test period on one circular list swept by three hands,
+ * and adapts how many frames cold pages get from how often test pages return.
+ */
+struct ClockProEngine : Engine {
+	enum { HOT, COLD, TEST };
+
+	// Circular list nodes, allocated from a pool of ids; node_of[page] is the
+	// node of a page on the list or -1
+	vector<int> node_page;
+	vector<int> node_status;
+	vector<int> node_referenced;
+	vector<int> next;
+	vector<int> prev;
+	vector<int> free_nodes;
+	vector<int> node_of;
+
+	int hand_hot;
+	int hand_cold;
+	int hand_test;
+
+	int count_hot;
+	int count_cold;
+	int count_test;
+	int cold_target;
+
+	// Set by fault() when the faulting page was still in its test period
+	int returning;
+
+	ClockProEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list);
+
+	void resize(int frames);
+
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void fault(int page);
+	void hit(int page, int frame);
+	void load(int page, int frame);
+	int victim();
+
+private:
+	void insert(int page, int status);
+	void remove(int node);
+	int runHandCold();
+	void runHandHot();
+	void runHandTest();
+};
+
+/*
+ * Multi-Queue keeps pages in LRU queues by how often they were referenced,
+ * demotes pages that stop being referenced one queue at a time, and remembers
+ * the reference counts of evicted pages for a while.
+ */
+struct MQEngine : Engine {
+	FrameLists queues;
+	vector<int> expire;
+	int life_time;
+
+	// Qout: recently evicted pages and the reference count each had
+	RingBuffer qout;
+	vector<unsigned int> qout_stamp;
+	vector<int> qout_frequency;
+
+	MQEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, int life_time);
+
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void hit(int page, int frame);
+	void load(int page, int frame);
+	int victim();
+
+private:
+	void enqueue(int frame);
+	void adjust();
+};
+
+/*
+ * Sampled eviction: instead of keeping pages ordered, sample a few resident
+ * frames at random on each eviction and evict the one a priority function
+ * ranks lowest.
+ */
+struct SampledEngine : Engine {
+	// Ranks a resident frame; the lowest ranked frame of a sample is evicted
+	typedef double (*Priority)(const SampledEngine &engine, int frame);
+
+	Priority priority;
+	int k;
+	Random random;
+	ResidentFrames resident;
+
+	// The number of references to the page in each frame and when it was
+	// loaded; the time of its last reference is in the frame table
+	vector<int> count;
+	vector<int> loaded;
+
+	SampledEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list,
+			string priority, int k, uint64_t seed);
+
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void hit(int page, int frame);
+	void load(int page, int frame);
+	int victim();
+};
+
+/*
+ * First in, first out: the victim is the page that was loaded longest ago
+ */
+struct FIFOEngine : Engine {
+	RingBuffer loaded;
+
+	FIFOEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list);
+
+	void report();
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void hit(int page, int frame) {}
+	void load(int page, int frame);
+	int victim();
+};
+
+/*
+ * FIFO for an allocation of at most FRAMES frames, a power of two. The queue
+ * is an array inside the engine rather than a vector beside it, and a
+ * reference is handled in one inlined function instead of through the virtual
+ * hit(), load() and victim() every other engine goes through, which is most of
+ * what a FIFO reference costs. createEngine() picks it for small allocations.
+ */
+template<int FRAMES> struct FixedFIFOEngine : Engine {
+	int loaded[FRAMES];
+	unsigned int head;
+	unsigned int tail;
+
+	FixedFIFOEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list);
+
+	int reference(int page, int write = 0);
+	void report();
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void hit(int page, int frame) {}
+	void load(int page, int frame);
+	int victim();
+};
+
+/*
+ * Most recently used: the victim is the page referenced last
+ */
+struct MRUEngine : Engine {
+	FrameLists order;
+
+	MRUEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list);
+
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void hit(int page, int frame);
+	void load(int page, int frame);
+	int victim();
+};
+
+/*
+ * Belady's optimal algorithm: the victim is the resident page whose next
+ * reference lies furthest in the future. It needs the whole reference string
+ * up front and must be fed it from the start.
+ */
+struct OPTEngine : Engine {
+	typedef std::pair<int, int> HeapEntry;
+
+	// When each reference's page is referenced next, or never
+	vector<int> next_use;
+
+	// The next reference to the page in each frame, and a max-heap of
+	// (next reference, frame) whose stale entries are skipped when popped
+	vector<int> next;
+	priority_queue<HeapEntry> heap;
+
+	OPTEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list,
+			const int *pages, int references);
+
+	void checkpointState(Checkpoint &c);
+
+protected:
+	void hit(int page, int frame);
+	void load(int page, int frame);
+	int victim();
+};
+
+/*
+ * A Fenwick (binary indexed) tree of counts over positions 0 to size - 1
+ */
+struct FenwickTree {
+	vector<int> tree;
+
+	FenwickTree(int size = 0);
+
+	void reset(int size);
+	void add(int position, int delta);
+
+	// The sum of the counts at positions 0 to position
+	int prefix(int position);
+};
+
+/*
+ * Exact LRU stack distances in one pass. Every page that has been referenced is
+ * marked in a Fenwick tree at the slot of its last reference, so the distance
+ * of a page is how many marks there are at or after its slot. Slots are handed
+ * out in order and renumbered once they run out, so the tree only ever holds
+ * twice as many slots as there are distinct pages.
+ */
+struct StackDistance {
+	FenwickTree marks;
+	vector<int> slot;
+	vector<int> owner;
+	int next_slot;
+	int distinct;
+
+	StackDistance();
+
+	// The stack distance of this reference, or 0 if the page is new
+	int reference(int page);
+
+private:
+	void compact();
+};
+
+/*
+ * A miss ratio curve built from the stack distance of every reference: hits[d]
+ * is the number of references at distance d, which a memory of d or more
+ * frames turns into hits, and the rest always miss
+ */
+struct MissRatioCurve {
+	string type;
+	long long references;
+	vector<long long> hits;
+
+	MissRatioCurve(string type);
+
+	void add(int distance);
+	long long misses(int frames) const;
+};
+
+/*
+ * A HyperLogLog counter of distinct pages. The sum behind the estimate is kept
+ * up to date as registers change, so an estimate costs no more than an add.
+ */
+struct HyperLogLog {
+	vector<uint8_t> registers;
+	double sum;
+	int zeros;
+
+	HyperLogLog();
+
+	void add(uint64_t hash);
+	double estimate() const;
+};
+
+/*
+ * Counter Stacks by Wires et al.: an approximate LRU miss ratio curve from a
+ * stream of references, keeping no state per page. A new HyperLogLog counter
+ * of distinct pages is started every COUNTER_STACKS_INTERVAL references, and a
+ * counter whose count has nearly caught up with the next older one is pruned,
+ * so only a logarithmic number of counters are ever alive. The histogram of
+ * stack distances is kept in logarithmic buckets, so its size is bounded too.
+ */
+struct CounterStacks {
+	struct Counter {
+		HyperLogLog distinct;
+		double count;
+	};
+
+	vector<Counter> counters;
+	vector<double> buckets;
+	long long references;
+	int pending;
+
+	CounterStacks();
+
+	void reference(int page);
+	MissRatioCurve curve();
+
+private:
+	void checkpoint();
+};
+
+/*
+ * Histogram buckets that grow with the logarithm of the value
+ */
+int logBucket(int value);
+int logBucketStart(int bucket);
+
+/*
+ * The AET (average eviction time) model of Hu et al.: an LRU miss ratio curve
+ * from the histogram of reuse times alone, which is far cheaper to collect than
+ * stack distances. With a budget, only the pages whose hash falls below a
+ * threshold are tracked, the threshold dropping whenever more than budget pages
+ * would be, and reuse times go into logarithmic buckets, so the model runs in
+ * fixed memory. Without one, every page is tracked and every reuse time counts.
+ */
+struct AverageEvictionTime {
+	int budget;
+	long long time;
+	double references;
+	vector<double> reuse;
+
+	// The time of each page's last reference when every page is tracked
+	vector<long long> last;
+
+	// The time of each sampled page's last reference, by its hash; the hash is
+	// a bijection, so it identifies the page
+	map<uint64_t, long long> sampled;
+	uint64_t threshold;
+
+	AverageEvictionTime(int budget = 0);
+
+	void reference(int page);
+	MissRatioCurve curve(string type);
+
+private:
+	void record(long long reuse_time, double weight);
+};
+
+/*
+ * A thread pool over numbered tasks with one deque of tasks per worker. A worker
+ * takes tasks from the back of its own deque and, once that is empty, steals
+ * from the front of the others', so no core sits idle while another still has
+ * a backlog of long simulations.
+ */
+struct WorkStealingPool {
+	struct Worker {
+		mutex lock;
+		deque<int> tasks;
+	};
+
+	vector<Worker> workers;
+
+	// Deals tasks 0 to tasks - 1 out to the workers in contiguous runs
+	WorkStealingPool(int workers, int tasks);
+
+	// Runs every task on the pool and returns once all of them are done
+	void run(std::function<void(int task)> body);
+
+private:
+	// The next task for worker w, or -1 once every deque is empty
+	int take(int w);
+};
+
+/*
+ * Engines for several algorithms, each on tables of its own, fed the same
+ * references as they arrive rather than from a reference string known up
+ * front
+ */
+struct EngineSet {
+	vector<vector<int> > page_tables;
+	vector<vector<int> > frame_tables;
+	vector<string> names;
+	vector<Engine *> engines;
+
+	// Builds an engine for every algorithm that can run online, saying which
+	// ones cannot
+	EngineSet(const vector<string> &types);
+	~EngineSet();
+
+	void reference(int page, int write);
+};
+
+void resetTables(int page_table[][3], int frame_table[][2], vector<int> &free_frame_list, int frames = max_page_frames);
+void runEngine(Engine &engine);
+void loadTrace(string filename, Trace &trace);
+void monteCarlo(string type, const Trace &trace, int runs);
+void beladySweep(string type, const Trace &trace, int max_frames);
+void fusedRun(const vector<string> &types, const Trace &trace);
+void followTrace(const vector<string> &types, int idle_polls);
+void serve(const vector<string> &types, string source, int socket_mode);
+MissRatioCurve lruCurve(const Trace &trace);
+MissRatioCurve parallelLruCurve(const Trace &trace, int chunks);
+MissRatioCurve optCurve(const Trace &trace);
+MissRatioCurve counterStacksCurve(const Trace &trace);
+MissRatioCurve aetCurve(const Trace &trace, int budget);
+void printCurves(const vector<MissRatioCurve> &curves);
+vector<string> splitList(const string &list);
+vector<int> parseFrameCounts(const string &ranges);
+int simulate(string policy, const Trace &trace, int frames, uint64_t seed, string *name = NULL);
+int simulate(string policy, const int *pages, const char *writes, int references, int frames, uint64_t seed, string *name = NULL);
+void sweep(const vector<string> &traces, const vector<string> &policies, const vector<int> &frame_counts, int seeds);
+void sweepProcesses(const vector<string> &traces, const vector<string> &policies, const vector<int> &frame_counts, int seeds,
+		int processes);
+void runManifest(string filename);
+
+int main(int argc, char *argv[]){
+	/*
+	 * Read the options:
+	 *   --verbose  print the reference string, and the page table after every
+	 *              fault of the algorithms that compare the policies
+	 *   --seed N   seed the reference string and the random algorithms with N
+	 *              instead of the time, so that a run can be repeated
+	 *   --pages N  give the page table N entries (default: DEFAULT_NUM_PAGES)
+	 *   --frames N give the process N frames (default: DEFAULT_PAGE_FRAMES)
+	 *   --references N
+	 *              generate N references (default: DEFAULT_POOL_SIZE)
+	 *   --runs R   run RAN and RAN2 with R different seeds and report the
+	 *              distribution of their faults instead of a single sample
+	 *   --trace F  read the reference string from F instead of generating one
+	 *   --belady N run FIFO with every frame count from 1 to N and report
+	 *              where adding a frame added faults
+	 *   --belady-policy P
+	 *              look for the anomaly in algorithm P instead of FIFO
+	 *   --mrc      print the faults of LRU and OPT for every number of frames
+	 *              at once, and the Counter Stacks and AET estimates of LRU's
+	 *   --fused    run FIFO, LRU, MRU, OPT, RAN and RAN2 in one pass over the
+	 *              reference string instead of one pass each
+	 *   --fused-policies P,Q,...
+	 *              run the listed algorithms in one pass instead
+	 *   --checkpoint F
+	 *              save the state of a fused run's algorithms to F as it goes
+	 *   --checkpoint-interval N
+	 *              save it every N references (default: CHECKPOINT_INTERVAL)
+	 *   --resume F run the algorithms saved in F from where they were saved,
+	 *              over this reference string or one sharing its beginning
+	 *   --follow   keep the algorithms running and feed them whatever is
+	 *              appended to the reference string, like tail -f, printing
+	 *              their faults after each batch
+	 *   --follow-idle N
+	 *              stop following after N checks that found nothing new
+	 *   --serve S  take batches of references from S, which is - for stdin
+	 *              or a named pipe, and answer queries for the faults so far
+	 *   --serve-socket P
+	 *              the same over connections to a Unix domain socket at P
+	 *   --sweep    run every combination of the sweep options below on all
+	 *              cores and print one CSV row per simulation as it finishes
+	 *   --sweep-traces F,G,...
+	 *              the reference strings to sweep (default: the usual one)
+	 *   --sweep-policies P,Q,...
+	 *              the algorithms to sweep (default: FIFO, LRU, MRU, OPT,
+	 *              RAN and RAN2)
+	 *   --sweep-frames A-B,C,...
+	 *              the frame counts to sweep (default: 1 to --frames)
+	 *   --sweep-seeds S
+	 *              run each simulation with seeds seed to seed + S - 1
+	 *   --processes N
+	 *              run the sweep in N forked worker processes instead of
+	 *              threads, printing the rows once all of them are done
+	 *   --manifest F
+	 *              run the experiment declared in F, skipping the results
+	 *              its output already holds for unchanged inputs
+	 */
+	random_seed = time(NULL);
+
+	int belady_frames = 0;
+	string belady_policy = "FIFO";
+	int miss_ratio_curve = 0;
+	int generate = 1;
+	vector<string> fused_policies;
+	int follow = 0;
+	int follow_idle = 0;
+	string serve_source;
+	int serve_socket = 0;
+
+	int sweeping = 0;
+	vector<string> sweep_traces;
+	const char *default_policies[] = { "FIFO", "LRU", "MRU", "OPT", "RAN", "RAN2" };
+	vector<string> sweep_policies(default_policies, default_policies + 6);
+	string sweep_frames_list;
+	vector<int> sweep_frames;
+	int sweep_seeds = 1;
+	int sweep_processes = 0;
+
+	string manifest;
+
+	for (int i = 1; i < argc; i++){
+		if (strcmp(argv[i], "--verbose") == 0){
+			enableVerboseOutput = 1;
+		} else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc){
+			random_seed = strtoull(argv[++i], NULL, 10);
+		} else if (strcmp(argv[i], "--pages") == 0 && i + 1 < argc){
+			max_num_pages = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc){
+			max_page_frames = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--references") == 0 && i + 1 < argc){
+			proc_pool_size = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc){
+			monte_carlo_runs = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc){
+			trace_filename = argv[++i];
+			generate = 0;
+		} else if (strcmp(argv[i], "--belady") == 0 && i + 1 < argc){
+			belady_frames = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--belady-policy") == 0 && i + 1 < argc){
+			belady_policy = argv[++i];
+		} else if (strcmp(argv[i], "--mrc") == 0){
+			miss_ratio_curve = 1;
+		} else if (strcmp(argv[i], "--fused") == 0){
+			fused_policies.assign(default_policies, default_policies + 6);
+		} else if (strcmp(argv[i], "--fused-policies") == 0 && i + 1 < argc){
+			fused_policies = splitList(argv[++i]);
+		} else if (strcmp(argv[i], "--follow") == 0){
+			follow = 1;
+		} else if (strcmp(argv[i], "--follow-idle") == 0 && i + 1 < argc){
+			follow_idle = std::max(0, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc){
+			serve_source = argv[++i];
+			serve_socket = 0;
+		} else if (strcmp(argv[i], "--serve-socket") == 0 && i + 1 < argc){
+			serve_source = argv[++i];
+			serve_socket = 1;
+		} else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc){
+			checkpoint_filename = argv[++i];
+		} else if (strcmp(argv[i], "--checkpoint-interval") == 0 && i + 1 < argc){
+			checkpoint_interval = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc){
+			resume_filename = argv[++i];
+		} else if (strcmp(argv[i], "--sweep") == 0){
+			sweeping = 1;
+		} else if (strcmp(argv[i], "--sweep-traces") == 0 && i + 1 < argc){
+			sweep_traces = splitList(argv[++i]);
+		} else if (strcmp(argv[i], "--sweep-policies") == 0 && i + 1 < argc){
+			sweep_policies = splitList(argv[++i]);
+		} else if (strcmp(argv[i], "--sweep-frames") == 0 && i + 1 < argc){
+			sweep_frames_list = argv[++i];
+		} else if (strcmp(argv[i], "--sweep-seeds") == 0 && i + 1 < argc){
+			sweep_seeds = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--processes") == 0 && i + 1 < argc){
+			sweep_processes = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--manifest") == 0 && i + 1 < argc){
+			manifest = argv[++i];
+		} else {
+			cout << "Unknown option: " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	// Sizes are only known once every option is read. The frame table has to
+	// hold the largest allocation the anomaly sweep tries.
+	max_page_frames = std::max(max_page_frames, belady_frames);
+	if (!sweep_frames_list.empty()){
+		sweep_frames = parseFrameCounts(sweep_frames_list);
+	}
+
+	/*
+	 * Seed the random number generator and create the addresses for the process.
+	 * The addresses reference what parts of the program should be paged in and
+	 * out
+	 */
+	srand(random_seed);
+
+	// A manifest names its own reference strings
+	if (!manifest.empty()){
+		runManifest(manifest);
+		return 0;
+	}
+
+	// Follow the reference string as it grows, or take references from a
+	// tracer. OPT cannot run on references that have not arrived yet, so it is
+	// left out unless asked for.
+	if (follow || !serve_source.empty()){
+		if (fused_policies.empty()){
+			const char *online[] = { "FIFO", "LRU", "MRU", "RAN", "RAN2" };
+			fused_policies.assign(online, online + 5);
+		}
+
+		if (follow){
+			followTrace(fused_policies, follow_idle);
+		} else {
+			serve(fused_policies, serve_source, serve_socket);
+		}
+		return 0;
+	}
+
+	if (generate){
+		createReferenceString();
+	}
+
+	// Run every combination of traces, algorithms, frame counts and seeds
+	if (sweeping){
+		if (sweep_traces.empty()){
+			sweep_traces.push_back(trace_filename);
+		}
+
+		if (sweep_frames.empty()){
+			for (int n = 1; n <= max_page_frames; ++n){
+				sweep_frames.push_back(n);
+			}
+		}
+
+		if (sweep_processes > 0){
+			sweepProcesses(sweep_traces, sweep_policies, sweep_frames, sweep_seeds, sweep_processes);
+		} else {
+			sweep(sweep_traces, sweep_policies, sweep_frames, sweep_seeds);
+		}
+		return 0;
+	}
+
+	// Look for Belady's anomaly instead of comparing the algorithms
+	if (belady_frames > 0){
+		Trace trace;
+		loadTrace(trace_filename, trace);
+
+		beladySweep(belady_policy, trace, belady_frames);
+		return 0;
+	}
+
+	// Print the miss ratio curves instead of comparing the algorithms
+	if (miss_ratio_curve){
+		Trace trace;
+		loadTrace(trace_filename, trace);
+
+		int chunks = std::max(1, std::min((int) thread::hardware_concurrency(), MAX_THREADS));
+
+		vector<MissRatioCurve> curves;
+		curves.push_back(parallelLruCurve(trace, chunks));
+		curves.push_back(optCurve(trace));
+		curves.push_back(counterStacksCurve(trace));
+		curves.push_back(aetCurve(trace, 0));
+		curves.push_back(aetCurve(trace, AET_SAMPLE_BUDGET));
+
+		printCurves(curves);
+		return 0;
+	}
+
+	// Compare the algorithms in a single pass over the reference string
+	if (!fused_policies.empty() || !resume_filename.empty()){
+		Trace trace;
+		loadTrace(trace_filename, trace);
+
+		fusedRun(fused_policies, trace);
+		return 0;
+	}
+
+	/* A page table is needed to store the mapping between virtual addresses
+	 * and physical addresses. For this process, the maximum number of entries
+	 * in the page table is LAS_SIZE / PAGE_SIZE, or 2^23 / 2^3 = 2^20.
+	 * This should be reflected in max_num_pages. The tables are sized at run
+	 * time, so they live on the heap rather than on main()'s stack.
+	 *
+	 * The first entry contains the base address of each page in physical
+	 * memory. The second entry contains whether this offset is valid. On
+	 * algorithms that require it, the third position is auxiliary.
+	 */
+	TableMemory page_memory(max_num_pages * 3);
+	int (*page_table)[3] = (int (*)[3]) page_memory.data;
+
+	/*
+	 * A free frame list is necessary for knowing what frames in physical memory
+	 * are free so proper frames can be allocated as necessary. At the beginning,
+	 * all pages are available due to our use of demand paging.
+	 */
+	 vector<int> free_frame_list(max_page_frames);
+
+	/*
+	 * A frame table is required to keep track of the allocation details of
+	 * physical memory. It keeps track of which frames are allocated, which
+	 * frames are available, how many total frames there are, and so on.
+	 *
+	 * The frame table has one entry for each physical page frame, indicating
+	 * whether the latter is free or allocated and, if it is allocated, to
+	 * which page of this process.
+	 *
+	 * The first column in the frame table designates what page is occupying
+	 * that entry (-1 is for entries that are not occupied). On
+	 * algorithms that require it, the second position is auxiliary.zz
+	 */
+	TableMemory frame_memory(max_page_frames * 2);
+	int (*frame_table)[2] = (int (*)[2]) frame_memory.data;
+
+	// Create the a string to hold the number of page references and
+	// if desired by the user, print them to the screen
+	string ref = displayReferenceString();
+
+	/*
+	 * Begin running simulations, starting with FIFO, then LRU, then
+	 * MRU, then OPT, then RAN, then RAN2
+	 */
+	resetTables(page_table, frame_table, free_frame_list);
+	FIFOEngine fifo(page_table, frame_table, free_frame_list);
+	runEngine(fifo);
+
+	// The sampled AET model predicts LRU's faults for next to nothing, ahead
+	// of the full simulation
+	Trace trace;
+	loadTrace(trace_filename, trace);
+
+	cout << "LRU (AET estimate): " << aetCurve(trace, AET_SAMPLE_BUDGET).misses(max_page_frames) << endl;
+
+	// LRU and MRU run on the same engines as the fused runs, sweeps and
+	// manifests, so every mode agrees on their faults
+	resetTables(page_table, frame_table, free_frame_list);
+	Engine *lru = createEngine("LRU", page_table, frame_table, free_frame_list);
+	runEngine(*lru);
+	delete lru;
+
+	resetTables(page_table, frame_table, free_frame_list);
+	MRUEngine mru(page_table, frame_table, free_frame_list);
+	runEngine(mru);
+
+	// Run the optimal page replacement algorithm as a benchmark
+	resetTables(page_table, frame_table, free_frame_list);
+	OPT(page_table, frame_table, free_frame_list, ref);
+
+	// Run a random page replacement algorithm to determine its effectiveness
+	// as compared to tried and true algorithms. This random replacement algorithm
+	// first tries the uniformly distributed method of random number generation
+	// and page replacement first, then the pseudorandom method. A single run
+	// of either is one sample, so with --runs both are run once per seed and
+	// summarized instead.
+	if (monte_carlo_runs > 1){
+		monteCarlo("RAN", trace, monte_carlo_runs);
+		monteCarlo("RAN2", trace, monte_carlo_runs);
+	} else {
+		resetTables(page_table, frame_table, free_frame_list);
+		RANEngine ran(page_table, frame_table, free_frame_list, "RAN", random_seed);
+		runEngine(ran);
+
+		resetTables(page_table, frame_table, free_frame_list);
+		RANEngine ran2(page_table, frame_table, free_frame_list, "RAN2", random_seed);
+		runEngine(ran2);
+	}
+
+	// Run LRU-K, the policy database buffer pools use in place of plain LRU,
+	// with a correlated reference period wide enough to swallow the runs of
+	// repeated references that createReferenceString() produces
+	resetTables(page_table, frame_table, free_frame_list);
+	LRUKEngine lruk(page_table, frame_table, free_frame_list, LRU_K, LRU_K_CORRELATED_PERIOD, LRU_K_RETAINED_PERIOD);
+	runEngine(lruk);
+
+	// Run S3-FIFO, which only sets a counter on a hit instead of reordering
+	// a list the way LRU has to
+	resetTables(page_table, frame_table, free_frame_list);
+	S3FIFOEngine s3fifo(page_table, frame_table, free_frame_list);
+	runEngine(s3fifo);
+
+	// Run SIEVE, where a hit only sets the visited bit of its frame
+	resetTables(page_table, frame_table, free_frame_list);
+	SIEVEEngine sieve(page_table, frame_table, free_frame_list);
+	runEngine(sieve);
+
+	// Run W-TinyLFU, the only engine here that may refuse to keep a page that
+	// was just faulted in
+	resetTables(page_table, frame_table, free_frame_list);
+	WTinyLFUEngine wtinylfu(page_table, frame_table, free_frame_list);
+	runEngine(wtinylfu);
+
+	// Run the working set policy and its clock approximation. Unlike the
+	// engines above they give frames back once pages fall out of the window,
+	// so they also report how many frames they actually needed.
+	resetTables(page_table, frame_table, free_frame_list);
+	WSEngine ws(page_table, frame_table, free_frame_list, WS_TAU);
+	runEngine(ws);
+
+	resetTables(page_table, frame_table, free_frame_list);
+	WSClockEngine wsclock(page_table, frame_table, free_frame_list, WS_TAU);
+	runEngine(wsclock);
+
+	// Run page-fault frequency allocation over LRU, which grows and shrinks
+	// the frames LRU gets to use with the rate at which it faults
+	resetTables(page_table, frame_table, free_frame_list);
+	Engine *pff = createEngine("PFF", page_table, frame_table, free_frame_list);
+	runEngine(*pff);
+	delete pff;
+
+	// Run NRU, which uses the writes marked in the reference string to tell
+	// clean pages from the dirty ones that cost a write-back to evict
+	resetTables(page_table, frame_table, free_frame_list);
+	NRUEngine nru(page_table, frame_table, free_frame_list, NRU_CLEAR_INTERVAL, random_seed);
+	runEngine(nru);
+
+	// Run CLOCK-Pro, which resists scans like LIRS at the cost of CLOCK
+	resetTables(page_table, frame_table, free_frame_list);
+	ClockProEngine clockpro(page_table, frame_table, free_frame_list);
+	runEngine(clockpro);
+
+	// Run Multi-Queue, built for second-level caches where an upstream cache
+	// has already absorbed the recency that LRU relies on
+	resetTables(page_table, frame_table, free_frame_list);
+	MQEngine mq(page_table, frame_table, free_frame_list, MQ_LIFE_TIME);
+	runEngine(mq);
+
+	// Run sampled eviction with each of its priority functions, which is how
+	// key-value stores approximate LRU and LFU without keeping any order
+	const char *priorities[] = { "SAMPLED-LRU", "SAMPLED-LFU", "SAMPLED-HYPERBOLIC" };
+
+	for (int i = 0; i < 3; i++){
+		resetTables(page_table, frame_table, free_frame_list);
+		Engine *sampled = createEngine(priorities[i], page_table, frame_table, free_frame_list);
+		runEngine(*sampled);
+		delete sampled;
+	}
+
+	return 0;
+}
+
+/*
+ * Checks to see if the reference held in the frame table matches the
+ * new reference. Useful for seeing if a page is already in memory or
+ * if a different page needs to be replaced.
+ */
+int isInMemory(int frame_table[][2], int page, int reference){
+	if (frame_table[page][0] == reference){
+		return 1;
+	} else {
+		return 0;
+	}
+}
+
+/*
+ * Reads one entry of the reference string: a page number, followed by a 'w' if
+ * the reference is a write. Since atoi() stops at the 'w', algorithms that do
+ * not care about writes can keep reading entries with atoi().
+ */
+int parseReference(string referenceString, int &write){
+	char last = referenceString.empty() ? 0 : referenceString[referenceString.size() - 1];
+
+	write = (last == 'w' || last == 'W');
+
+	return atoi(referenceString.c_str());
+}
+
+/*
+ * Whether a page has an entry in the page table. A page past its end would be
+ * written outside it, so every algorithm skips it and counts it in skipped.
+ */
+int pageInRange(int page, int &skipped){
+	if (page < 0 || page >= max_num_pages){
+		skipped++;
+		return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Tells the user how many references of a reference string were skipped by
+ * pageInRange(). Every algorithm reads the same file, so it is only said once.
+ */
+void reportSkipped(string filename, int skipped){
+	static std::set<string> reported;
+
+	if (skipped > 0 && reported.insert(filename).second){
+		cout << filename << ": skipped " << skipped << " references to pages past " << max_num_pages - 1 << "; see --pages" << endl;
+	}
+}
+
+/*
+ * Splits a comma separated list of options into its items
+ */
+vector<string> splitList(const string &list){
+	vector<string> items;
+	size_t start = 0, comma;
+
+	while ((comma = list.find(',', start)) != string::npos){
+		items.push_back(list.substr(start, comma - start));
+		start = comma + 1;
+	}
+	items.push_back(list.substr(start));
+
+	return items;
+}
+
+/*
+ * Reads a comma separated list of frame counts and ranges of them such as
+ * "1-8,16,32", leaving out counts outside 1 to max_page_frames
+ */
+vector<int> parseFrameCounts(const string &ranges){
+	vector<string> items = splitList(ranges);
+	vector<int> counts;
+
+	for (size_t r = 0; r < items.size(); ++r){
+		size_t dash = items[r].find('-');
+		int low = atoi(items[r].c_str());
+		int high = dash == string::npos ? low : atoi(items[r].c_str() + dash + 1);
+
+		for (int n = std::max(1, low); n <= std::min(high, max_page_frames); ++n){
+			counts.push_back(n);
+		}
+	}
+
+	return counts;
+}
+
+/*
+ * Displays the reference string in row order on the console to the user
+ */
+string displayReferenceString(){
+    string pageList;
+    string temp;
+
+	ifstream addresses;
+	addresses.open(trace_filename.c_str());
+
+	 if (addresses.is_open()) {
+        while (!addresses.eof()) {
+            addresses >> temp;
+            pageList += temp + "\t";
+        }
+	 }
+	 addresses.close();
+
+	 if (enableVerboseOutput){
+		cout << "Reference strings (in row order):\n" << pageList << endl;
+	 }
+
+	 return pageList;
+}
+
+/*
+ * Display the page table after each page fault if it is requested by the user.
+ * Depending on the algorithm, the output will be different.
+ */
+void displayPageTable(int page_table[][3], string type){
+	cout << "Page Replacement Algorithm: " << type << endl;
+	cout << "Page\t" << "Valid/Invalid Bit\t" << "Auxiliary\t" << endl;
+
+	if (type == "FIFO" || type == "RAN" || type == "OPT") {
+		for (int i = 0; i < max_num_pages; i++){
+			cout << page_table[i][0] << "\t" << page_table[i][1] << endl;
+		}
+	} else {
+		for (int i = 0; i < max_num_pages; i++){
+			cout << page_table[i][0] << "\t" << page_table[i][1] << "\t" << page_table[i][2] << endl;
+		}
+	}
+}
+
+/*
+ * Implement the optimal page replacement algorithm by first examining the input string of reference addresses and
+ * constructing a table by which we would be able to infer the optimal page to replace at each point in the program.
+ * Then, run the algorithm again on the same reference addresses using this table as a guide to determine what pages
+ * to replace.
+ */
+
+void OPT(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, string ref){
+	// Start by reading in addresses that the program would access in sequential order from the file
+	ifstream addresses, oracle;
+	oracle.open(trace_filename.c_str());
+
+	string referenceString;
+	// Fill a vector with the reference strings so that they can be referenced later
+	// when we are trying to predict pages to remove
+	vector<int> reference_string;
+	int skipped = 0;
+	for (int i = 0; i < proc_pool_size; i++){
+		oracle >> referenceString;
+		int page = atoi(referenceString.c_str());
+
+		// Pages that are skipped below must not be foreseen either
+		if (pageInRange(page, skipped)){
+			reference_string.push_back(page);
+		}
+	}
+	skipped = 0;
+
+	oracle.close();
+	addresses.open(trace_filename.c_str());
+
+	int reference = 0;
+	int fault_rate = 0;
+	int loops = 0;
+
+	/*
+	 * Continue reading from the file only if the file is open and not at the end of its input
+	 */
+	if (addresses.is_open()){
+		while (!addresses.eof()) {
+			addresses >> referenceString;
+			reference = atoi(referenceString.c_str());
+
+			if (!pageInRange(reference, skipped)){
+				continue;
+			}
+
+			if (page_table[reference][1] == INVALID_BIT){
+				int freeframe = 0;
+
+				// If we have no more free frames to allocate, then all of the
+				// slots in the frame table must be occupied.
 				if (free_frame_list.size() == 0){
 					freeframe = identifyPageToRemove(frame_table, reference_string);
 				} else {
 					// Pick a free frame from the back of the list
 					freeframe = free_frame_list.back();
 
-					// Remove this page from the free frame list and decrease the size of the
-					// list by one.
-					free_frame_list.pop_back();
+					// Remove this page from the free frame list and decrease the size of the
+					// list by one.
+					free_frame_list.pop_back();
+				}
+
+				// Update the tables
+				page_table[reference][0] = freeframe;
+				page_table[reference][1] = VALID_BIT;
+
+				frame_table[freeframe][0] = reference;
+				fault_rate++;
+
+				// Show the page table after every fault if the user asked for it
+				if (enableVerboseOutput){
+					displayPageTable(page_table, "OPT");
+				}
+
+			} else if (!isInMemory(frame_table, page_table[reference][0], reference)){
+				int freeframe = identifyPageToRemove(frame_table, reference_string);
+
+				// Place the reference to this frame into the page table
+				int oldframe = page_table[reference][0];
+				int oldpage = frame_table[freeframe][0];
+
+				page_table[oldpage][1] = INVALID_BIT;
+
+				page_table[reference][0] = freeframe;
+				page_table[reference][1] = VALID_BIT;
+				frame_table[freeframe][0] = reference;
+
+				// Push the newly available frame back onto the vector
+				free_frame_list.push_back(oldframe);
+				fault_rate++;
+
+				// Show the page table after every fault if the user asked for it
+				if (enableVerboseOutput){
+					displayPageTable(page_table, "OPT");
+				}
+			}
+
+			// Remove the first element in the vector as long as there is one. There
+			// will only be one case where there are no more elements left in the vector
+			// but the method should summarily exit once this is found by having discovered
+			// that there is no more input left in the file.
+			if (reference_string.size() > 0){
+				reference_string.erase(reference_string.begin());
+			}
+
+		}
+	}
+
+	// Display the OPT fault rate
+	reportSkipped(trace_filename, skipped);
+	cout << "OPT : " << fault_rate << endl;
+	addresses.close();
+}
+
+/*
+ * A method used solely by the optimal page replacement algorithm. Given a reference string
+ * and a frame table, the reference string and the frame table is compared to check which
+ * currently occupied frame in the frame table will be used the farthest in time from the
+ * current element. Said element will then be chosen for removal
+ */
+int identifyPageToRemove(int frame_table[][2], const vector<int> &reference_string){
+    int victim = 0;
+
+	// No free frames are available, so we must use the page reference string
+	// to identify which page is going to be used last and replace it
+	vector<int> futureref(max_page_frames);
+
+	// All elements should be initialized to a positive invalid number. That way,
+	// if it is never accessed again then we can tell because it will have a high
+	// (essentially infinite) number of moves that it will require to get there
+	for (int i = 0; i < max_page_frames; ++i){
+		futureref[i] = proc_pool_size + 100;
+	}
+
+	// Given this element and all elements in the frame table,
+	// determine if any element in the frame table is referenced
+	// again. If it is, place the value of turns that it will take to
+	// get there into the array
+	for (int i = 0; i < max_page_frames; ++i){
+		for (int j = 0; j < reference_string.size(); j++){
+			if (reference_string.at(j) == frame_table[i][0]){
+				futureref[i] = j;
+				break;
+			}
+		}
+	}
+
+	// Find the value with the largest amount of turns that it will take to
+	// get there and use that as the frame that should be freed
+	int max_turns = -1;
+
+	for (int i = 0; i < max_page_frames; ++i){
+		if (futureref[i] > max_turns){
+			max_turns = futureref[i];
+            victim = i;
+		}
+	}
+
+	return victim;
+}
+
+/*
+ * Create a series of page reference strings that the process will access
+ */
+void createReferenceString(){
+    int lcv;
+    FILE *ref = fopen(trace_filename.c_str(), "w+");
+
+	fprintf(ref, "%i\n", 0);
+    lcv = 1;
+
+    while (lcv < proc_pool_size){
+        int randNum, reference, q;
+
+        // To simulate locality, a page has a 1/5 chance of
+		// being accessed again
+        randNum = rand() % 5;
+		reference = (double) rand() / (RAND_MAX+1.0) * (max_num_pages);
+
+		for (q = 0; q < randNum; ++q){
+			// Mark some of the references as writes
+			if (rand() % 100 < WRITE_PERCENT){
+				fprintf(ref, "%iw\n", reference);
+			} else {
+				fprintf(ref, "%i\n", reference);
+			}
+			++lcv;
+		}
+    }
+
+	// Close the file pointer
+	fclose(ref);
+}
+
+/*
+ * Set the initial data for the tables an engine will use. The page_table and
+ * frame_table are initialized to invalid and the free frame list holds every
+ * frame from 0 to frames exactly once, which is how many frames the engine
+ * will get to use.
+ */
+void resetTables(int page_table[][3], int frame_table[][2], vector<int> &free_frame_list, int frames){
+	for (int i = 0; i < max_num_pages; i++){
+		page_table[i][0] = INVALID_BIT;
+		page_table[i][1] = INVALID_BIT;
+		page_table[i][2] = INVALID_BIT;
+	}
+
+	for (int i = 0; i < max_page_frames; i++){
+		frame_table[i][0] = -1;
+		frame_table[i][1] = INVALID_BIT;
+	}
+
+	free_frame_list.clear();
+	for (int i = 0; i < frames; i++){
+		free_frame_list.push_back(i);
+	}
+}
+
+TableMemory::TableMemory(size_t ints) : data(NULL), bytes(std::max(ints, (size_t) 1) * sizeof(int)){
+	void *memory = MAP_FAILED;
+
+	if (bytes >= HUGE_PAGE_SIZE){
+		bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+		memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+		if (memory == MAP_FAILED){
+			memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (memory != MAP_FAILED){
+				madvise(memory, bytes, MADV_HUGEPAGE);
+			}
+		}
+	} else {
+		memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	}
+
+	if (memory == MAP_FAILED){
+		cout << "Cannot allocate a table of " << bytes << " bytes" << endl;
+		exit(1);
+	}
+
+	data = (int *) memory;
+}
+
+TableMemory::~TableMemory(){
+	munmap(data, bytes);
+}
+
+/*
+ * Reads a whole reference string into memory
+ */
+void loadTrace(string filename, Trace &trace){
+	ifstream addresses;
+	addresses.open(filename.c_str());
+
+	string referenceString;
+	int write = 0;
+
+	trace.pages.clear();
+	trace.writes.clear();
+
+	int skipped = 0;
+
+	while (addresses >> referenceString){
+		int page = parseReference(referenceString, write);
+
+		if (!pageInRange(page, skipped)){
+			continue;
+		}
+
+		trace.pages.push_back(page);
+		trace.writes.push_back(write);
+	}
+
+	addresses.close();
+
+	reportSkipped(filename, skipped);
+}
+
+/*
+ * Feeds every reference in the reference string to an engine, offering to show
+ * the page table after each fault like the other algorithms do, and prints the
+ * number of faults it took.
+ */
+void runEngine(Engine &engine){
+	ifstream addresses;
+	addresses.open(trace_filename.c_str());
+
+	string referenceString;
+	int write = 0;
+	int skipped = 0;
+
+	if (addresses.is_open()){
+		while (addresses >> referenceString) {
+			int page = parseReference(referenceString, write);
+
+			if (!pageInRange(page, skipped) || !engine.reference(page, write)){
+				continue;
+			}
+
+			// Show the page table after every fault if the user asked for it
+			if (enableVerboseOutput){
+				displayPageTable(engine.page_table, engine.type);
+			}
+		}
+	}
+
+	reportSkipped(trace_filename, skipped);
+	engine.report();
+	addresses.close();
+}
+
+Engine::Engine(string type, int page_table[][3], int frame_table[][2], vector<int> free_frame_list)
+	: type(type), page_table(page_table), frame_table(frame_table), free_frame_list(free_frame_list),
+	  frames(free_frame_list.size()), fault_rate(0), time(0), writing(0){
+}
+
+int Engine::isResident(int page){
+	return page_table[page][1] == VALID_BIT && isInMemory(frame_table, page_table[page][0], page);
+}
+
+int Engine::reference(int page, int write){
+	++time;
+	writing = write;
+
+	if (isResident(page)){
+		hit(page, page_table[page][0]);
+		return 0;
+	}
+
+	fault(page);
+
+	int freeframe = 0;
+
+	// Take a frame off the free frame list while there is one, otherwise
+	// the policy has to give one up
+	if (free_frame_list.size() == 0){
+		freeframe = evict();
+	} else {
+		freeframe = free_frame_list.back();
+		free_frame_list.pop_back();
+	}
+
+	page_table[page][0] = freeframe;
+	page_table[page][1] = VALID_BIT;
+	frame_table[freeframe][0] = page;
+
+	load(page, freeframe);
+	fault_rate++;
+
+	return 1;
+}
+
+int Engine::evict(){
+	int freeframe = victim();
+	discard(freeframe);
+
+	return freeframe;
+}
+
+void Engine::discard(int frame){
+	if (frame_table[frame][0] != -1){
+		page_table[frame_table[frame][0]][1] = INVALID_BIT;
+		frame_table[frame][0] = -1;
+	}
+}
+
+void Engine::resize(int frames){
+	this->frames = frames;
+}
+
+void Engine::report(){
+	cout << type << ": " << fault_rate << endl;
+}
+
+/*
+ * LRU-K as described by O'Neil, O'Neil and Weikum. Each page remembers the
+ * times of its last K uncorrelated references, and the victim is the resident
+ * page whose K-th most recent reference lies furthest in the past; pages with
+ * fewer than K references count as infinitely old and among those the least
+ * recently used goes first.
+ *
+ * References that arrive within the correlated reference period of the
+ * previous reference to the same page are treated as part of one burst: they
+ * only move LAST(p), and a page is not eligible for eviction until its burst is
+ * over. The history of an evicted page is retained for the retained period so
+ * that a page that comes back picks up where it left off.
+ *
+ * Resident pages are kept in a min-heap keyed on (HIST(p,K), HIST(p,1)), so a
+ * fault costs O(log F) rather than a scan over the frame table.
+ */
+LRUKEngine::LRUKEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list,
+		int k, int correlated_period, int retained_period)
+	: Engine("", page_table, frame_table, free_frame_list), k(k), correlated_period(correlated_period),
+	  retained_period(retained_period), hist(max_num_pages * k, 0), last(max_num_pages, 0), stamp(max_num_pages, 0){
+	char name[32];
+	sprintf(name, "LRU-%d", k);
+	type = name;
+}
+
+void LRUKEngine::hit(int page, int frame){
+	int *h = &hist[page * k];
+
+	// A reference outside the correlated period closes the previous burst. The
+	// burst collapses into one reference, so the older history is shifted by
+	// the length of the burst before the new reference is recorded.
+	if (time - last[page] > correlated_period){
+		int correlated = last[page] - h[0];
+
+		for (int i = k - 1; i > 0; --i){
+			h[i] = h[i - 1] ? h[i - 1] + correlated : 0;
+		}
+		h[0] = time;
+
+		++stamp[page];
+		push(page);
+	}
+
+	last[page] = time;
+}
+
+void LRUKEngine::load(int page, int frame){
+	int *h = &hist[page * k];
+
+	// Pages that were never seen, or whose history has outlived the retained
+	// period, start over with no history
+	if (last[page] == 0 || time - last[page] > retained_period){
+		for (int i = 0; i < k; ++i){
+			h[i] = 0;
+		}
+	} else {
+		for (int i = k - 1; i > 0; --i){
+			h[i] = h[i - 1];
+		}
+	}
+
+	h[0] = time;
+	last[page] = time;
+
+	++stamp[page];
+	push(page);
+}
+
+int LRUKEngine::victim(){
+	vector<HeapEntry> held;
+	int victim = -1;
+
+	while (!heap.empty()){
+		HeapEntry top = heap.top();
+		heap.pop();
+
+		if (top.stamp != stamp[top.page] || !isResident(top.page)){
+			continue;
+		}
+
+		// Pages still inside their correlated period may not be evicted
+		held.push_back(top);
+		if (time - last[top.page] > correlated_period){
+			victim = top.page;
+			break;
+		}
+	}
+
+	// If every resident page is inside its correlated period fall back to the
+	// one with the oldest K-th reference
+	if (victim == -1){
+		victim = held.front().page;
+	}
+
+	for (size_t i = 0; i < held.size(); ++i){
+		if (held[i].page != victim){
+			heap.push(held[i]);
+		}
+	}
+
+	++stamp[victim];
+
+	// Stale entries pile up on every uncorrelated hit, so compact the heap
+	// once they outnumber the live ones
+	if (heap.size() > (size_t) (4 * frames + 64)){
+		rebuild();
+	}
+
+	return page_table[victim][0];
+}
+
+void LRUKEngine::push(int page){
+	HeapEntry entry;
+	entry.kth = hist[page * k + k - 1];
+	entry.first = hist[page * k];
+	entry.page = page;
+	entry.stamp = stamp[page];
+
+	heap.push(entry);
+}
+
+void LRUKEngine::rebuild(){
+	heap = priority_queue<HeapEntry, vector<HeapEntry>, greater<HeapEntry> >();
+
+	for (int i = 0; i < max_page_frames; ++i){
+		int page = frame_table[i][0];
+
+		if (page >= 0 && isResident(page)){
+			++stamp[page];
+			push(page);
+		}
+	}
+}
+
+RingBuffer::RingBuffer(int capacity) : mask(0), head(0), tail(0){
+	unsigned int size = 1;
+
+	while (size < (unsigned int) capacity){
+		size <<= 1;
+	}
+
+	slots.resize(size);
+	mask = size - 1;
+}
+
+/*
+ * S3-FIFO as described by Yang et al. Pages enter a small FIFO holding about a
+ * tenth of the frames. A page leaving the small FIFO moves on to the main FIFO
+ * if it was hit more than S3FIFO_PROMOTE_THRESHOLD times while it was there,
+ * and is evicted into the ghost FIFO otherwise. The main FIFO reinserts any
+ * page whose frequency counter is still non-zero, decrementing it, so it
+ * behaves like CLOCK with a 2-bit counter. A faulting page that is still in the
+ * ghost FIFO goes straight to main.
+ *
+ * The frequency counter lives in the auxiliary column of the frame table. A
+ * hit only increments it, so hits never touch a queue.
+ */
+S3FIFOEngine::S3FIFOEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list)
+	: Engine("S3-FIFO", page_table, frame_table, free_frame_list), small_fifo(max_page_frames), main_fifo(max_page_frames),
+	  ghost_fifo(max_page_frames), ghost_stamp(max_num_pages, 0){
+	resize(frames);
+}
+
+void S3FIFOEngine::resize(int frames){
+	Engine::resize(frames);
+
+	small_target = std::max(1, frames * S3FIFO_SMALL_PERCENT / 100);
+	ghost_capacity = std::max(1, frames - small_target);
+}
+
+int S3FIFOEngine::inGhost(int page){
+	unsigned int stamp = ghost_stamp[page];
+
+	return stamp != 0 && stamp - 1 - ghost_fifo.head < (unsigned int) ghost_fifo.size();
+}
+
+void S3FIFOEngine::hit(int page, int frame){
+	if (frame_table[frame][1] < 3){
+		frame_table[frame][1]++;
+	}
+}
+
+void S3FIFOEngine::load(int page, int frame){
+	frame_table[frame][1] = 0;
+
+	if (inGhost(page)){
+		ghost_stamp[page] = 0;
+		main_fifo.push(page);
+	} else {
+		small_fifo.push(page);
+	}
+}
+
+int S3FIFOEngine::victim(){
+	while (true){
+		if (small_fifo.size() >= small_target || main_fifo.size() == 0){
+			int page = small_fifo.pop();
+			int frame = page_table[page][0];
+
+			if (frame_table[frame][1] > S3FIFO_PROMOTE_THRESHOLD){
+				frame_table[frame][1] = 0;
+				main_fifo.push(page);
+				continue;
+			}
+
+			// Remember the page in the ghost queue, dropping the oldest ghost
+			// once it is full
+			if (ghost_fifo.size() >= ghost_capacity){
+				ghost_fifo.pop();
+			}
+			ghost_stamp[page] = ghost_fifo.tail + 1;
+			ghost_fifo.push(page);
+
+			return frame;
+		}
+
+		int page = main_fifo.pop();
+		int frame = page_table[page][0];
+
+		if (frame_table[frame][1] > 0){
+			frame_table[frame][1]--;
+			main_fifo.push(page);
+			continue;
+		}
+
+		return frame;
+	}
+}
+
+/*
+ * SIEVE as described by Zhang et al. New pages go in at the head of a FIFO and
+ * never move. On a fault the hand walks from where it stopped last time towards
+ * the head, clearing the visited bit of every page it passes, and evicts the
+ * first page whose bit was already clear; when it runs off the head it starts
+ * again from the tail. Survivors stay where they are, so old pages that keep
+ * being hit are only ever looked at once per sweep.
+ *
+ * The visited bit lives in the auxiliary column of the frame table.
+ */
+SIEVEEngine::SIEVEEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list)
+	: Engine("SIEVE", page_table, frame_table, free_frame_list), prev(max_page_frames, -1), next(max_page_frames, -1),
+	  head(-1), tail(-1), hand(-1){
+}
+
+void SIEVEEngine::hit(int page, int frame){
+	frame_table[frame][1] = VALID_BIT;
+}
+
+void SIEVEEngine::load(int page, int frame){
+	frame_table[frame][1] = INVALID_BIT;
+
+	prev[frame] = -1;
+	next[frame] = head;
+
+	if (head != -1){
+		prev[head] = frame;
+	} else {
+		tail = frame;
+	}
+	head = frame;
+}
+
+int SIEVEEngine::victim(){
+	int frame = hand != -1 ? hand : tail;
+
+	while (frame_table[frame][1] == VALID_BIT){
+		frame_table[frame][1] = INVALID_BIT;
+		frame = prev[frame] != -1 ? prev[frame] : tail;
+	}
+
+	// The hand stays put for the next fault, just past the victim
+	hand = prev[frame];
+
+	if (prev[frame] != -1){
+		next[prev[frame]] = next[frame];
+	} else {
+		head = next[frame];
+	}
+
+	if (next[frame] != -1){
+		prev[next[frame]] = prev[frame];
+	} else {
+		tail = prev[frame];
+	}
+
+	return frame;
+}
+
+FrameLists::FrameLists(int lists, int frames)
+	: prev(frames, -1), next(frames, -1), list(frames, -1), head(lists, -1), tail(lists, -1), size(lists, 0){
+}
+
+void FrameLists::pushFront(int l, int frame){
+	prev[frame] = -1;
+	next[frame] = head[l];
+
+	if (head[l] != -1){
+		prev[head[l]] = frame;
+	} else {
+		tail[l] = frame;
+	}
+
+	head[l] = frame;
+	list[frame] = l;
+	size[l]++;
+}
+
+void FrameLists::remove(int frame){
+	int l = list[frame];
+
+	if (prev[frame] != -1){
+		next[prev[frame]] = next[frame];
+	} else {
+		head[l] = next[frame];
+	}
+
+	if (next[frame] != -1){
+		prev[next[frame]] = prev[frame];
+	} else {
+		tail[l] = prev[frame];
+	}
+
+	list[frame] = -1;
+	size[l]--;
+}
+
+/*
+ * Mixes a page number into 64 well distributed bits (the splitmix64 finalizer)
+ */
+static inline uint64_t hashPage(uint64_t page){
+	page += 0x9e3779b97f4a7c15ULL;
+	page = (page ^ (page >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	page = (page ^ (page >> 27)) * 0x94d049bb133111ebULL;
+	return page ^ (page >> 31);
+}
+
+/*
+ * The sketch holds about sixteen counters per frame, rounded up to a power of
+ * two, which for the default frame count is 64 words and stays in L1. Each of
+ * the four rows derives its counter from the same page hash with its own
+ * multiply-shift, so the four lanes are independent and the compiler can
+ * vectorize them. Every sample_size increments all counters are halved so that
+ * the sketch follows recent frequency rather than all-time frequency.
+ *
+ * The doorkeeper absorbs the first reference to a page, so pages that are only
+ * referenced once never reach the counters.
+ */
+FrequencySketch::FrequencySketch(int frames) : additions(0){
+	int words = 1;
+
+	while (words < frames){
+		words <<= 1;
+	}
+
+	table.assign(words, 0);
+	counter_bits = 4;
+	while ((1 << counter_bits) < words * 16){
+		counter_bits++;
+	}
+
+	sample_size = std::max(1, frames * WTINYLFU_SAMPLE_FACTOR);
+
+	int bits = 64;
+	while (bits < sample_size){
+		bits <<= 1;
+	}
+
+	doorkeeper.assign(bits / 64, 0);
+	doorkeeper_mask = bits - 1;
+}
+
+/*
+ * Follows a change in the number of frames without forgetting what the sketch
+ * has counted. A page's counters are picked by the top bits of its hashes, so
+ * when the table grows each new counter starts from the old counter that its
+ * bits narrow down to, and when it shrinks each new counter is the sum of the
+ * old counters folded into it; either way no page is estimated below what it
+ * was. The doorkeeper's bits cannot be carried over, so it only starts over
+ * when its size changes.
+ */
+void FrequencySketch::resize(int frames){
+	FrequencySketch resized(frames);
+
+	if (resized.table.size() == table.size()){
+		resized.table.swap(table);
+	} else {
+		for (unsigned int i = 0; i < (1u << resized.counter_bits); ++i){
+			int count;
+
+			if (resized.counter_bits >= counter_bits){
+				count = counter(i >> (resized.counter_bits - counter_bits));
+			} else {
+				int shift = counter_bits - resized.counter_bits;
+				count = 0;
+
+				for (unsigned int j = i << shift; j < (i + 1) << shift; ++j){
+					count += counter(j);
+				}
+			}
+
+			resized.setCounter(i, std::min(count, 15));
+		}
+	}
+
+	if (resized.doorkeeper.size() == doorkeeper.size()){
+		resized.doorkeeper.swap(doorkeeper);
+	}
+
+	resized.additions = additions;
+	*this = resized;
+
+	while (additions >= sample_size){
+		halve();
+	}
+}
+
+int FrequencySketch::counter(unsigned int index) const {
+	return (int) ((table[index >> 4] >> ((index & 15) << 2)) & 15);
+}
+
+void FrequencySketch::setCounter(unsigned int index, int count){
+	int shift = (index & 15) << 2;
+
+	table[index >> 4] = (table[index >> 4] & ~(15ULL << shift)) | ((uint64_t) count << shift);
+}
+
+void FrequencySketch::indexes(int page, unsigned int index[4]){
+	static const uint64_t seeds[4] = {
+		0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL
+	};
+	uint64_t hash = hashPage(page);
+
+	for (int i = 0; i < 4; ++i){
+		index[i] = (unsigned int) ((hash * seeds[i]) >> (64 - counter_bits));
+	}
+}
+
+int FrequencySketch::inDoorkeeper(int page, int add){
+	uint64_t hash = hashPage(page);
+	unsigned int a = (unsigned int) hash & doorkeeper_mask;
+	unsigned int b = (unsigned int) (hash >> 32) & doorkeeper_mask;
+	int found = ((doorkeeper[a >> 6] >> (a & 63)) & 1) && ((doorkeeper[b >> 6] >> (b & 63)) & 1);
+
+	if (add){
+		doorkeeper[a >> 6] |= 1ULL << (a & 63);
+		doorkeeper[b >> 6] |= 1ULL << (b & 63);
+	}
+
+	return found;
+}
+
+void FrequencySketch::increment(int page){
+	if (inDoorkeeper(page, 1)){
+		unsigned int index[4];
+		indexes(page, index);
+
+		for (int i = 0; i < 4; ++i){
+			uint64_t &word = table[index[i] >> 4];
+			int shift = (index[i] & 15) << 2;
+
+			if (((word >> shift) & 15) < 15){
+				word += 1ULL << shift;
+			}
+		}
+	}
+
+	if (++additions == sample_size){
+		halve();
+	}
+}
+
+int FrequencySketch::estimate(int page){
+	unsigned int index[4];
+	indexes(page, index);
+
+	int frequency = 15;
+	for (int i = 0; i < 4; ++i){
+		int count = counter(index[i]);
+		frequency = std::min(frequency, count);
+	}
+
+	return frequency + inDoorkeeper(page, 0);
+}
+
+void FrequencySketch::halve(){
+	for (size_t i = 0; i < table.size(); ++i){
+		table[i] = (table[i] >> 1) & 0x7777777777777777ULL;
+	}
+
+	for (size_t i = 0; i < doorkeeper.size(); ++i){
+		doorkeeper[i] = 0;
+	}
+
+	additions /= 2;
+}
+
+/*
+ * W-TinyLFU as described by Einziger, Friedman and Manes. Faulted pages enter
+ * an LRU window of about one percent of the frames. The main region is a
+ * segmented LRU: pages admitted from the window start in the probation segment
+ * and move to the protected segment when they are hit there, and the protected
+ * segment spills its least recently used page back into probation when it
+ * grows past its share.
+ *
+ * When a frame is needed, the window's least recently used page competes with
+ * the probation segment's least recently used page and the one the sketch
+ * considers less frequent is evicted. A page referenced once therefore cannot
+ * push out a page that is referenced regularly.
+ */
+WTinyLFUEngine::WTinyLFUEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list)
+	: Engine("W-TinyLFU", page_table, frame_table, free_frame_list), lists(3, max_page_frames), sketch(frames){
+	resize(frames);
+}
+
+void WTinyLFUEngine::resize(int frames){
+	Engine::resize(frames);
+
+	// The sketch's width and reset period follow the frames the engine has,
+	// so the same allocation behaves the same whatever --frames is
+	sketch.resize(frames);
+
+	window_capacity = std::max(1, frames * WTINYLFU_WINDOW_PERCENT / 100);
+	protected_capacity = (frames - window_capacity) * WTINYLFU_PROTECTED_PERCENT / 100;
+}
+
+void WTinyLFUEngine::hit(int page, int frame){
+	sketch.increment(page);
+
+	int l = lists.list[frame];
+	lists.remove(frame);
+
+	if (l == PROBATION){
+		lists.pushFront(PROTECTED, frame);
+
+		if (lists.size[PROTECTED] > protected_capacity){
+			int demoted = lists.tail[PROTECTED];
+			lists.remove(demoted);
+			lists.pushFront(PROBATION, demoted);
+		}
+	} else {
+		lists.pushFront(l, frame);
+	}
+}
+
+void WTinyLFUEngine::load(int page, int frame){
+	sketch.increment(page);
+	lists.pushFront(WINDOW, frame);
+
+	// While free frames are left nothing is evicted, so a window that grew
+	// past its share simply hands its oldest page to probation
+	if (lists.size[WINDOW] > window_capacity){
+		int oldest = lists.tail[WINDOW];
+		lists.remove(oldest);
+		lists.pushFront(PROBATION, oldest);
+	}
+}
+
+int WTinyLFUEngine::victim(){
+	int candidate = lists.tail[WINDOW];
+	int victim = lists.tail[PROBATION] != -1 ? lists.tail[PROBATION] : lists.tail[PROTECTED];
+
+	if (candidate == -1){
+		lists.remove(victim);
+		return victim;
+	}
+
+	lists.remove(candidate);
+
+	if (victim == -1 || sketch.estimate(frame_table[candidate][0]) <= sketch.estimate(frame_table[victim][0])){
+		return candidate;
+	}
+
+	lists.remove(victim);
+	lists.pushFront(PROBATION, candidate);
+
+	return victim;
+}
+
+ResidentSetTrace::ResidentSetTrace(int interval) : interval(interval), total(0), references(0), peak(0){
+}
+
+void ResidentSetTrace::record(int time, int resident){
+	total += resident;
+	references++;
+	peak = std::max(peak, resident);
+
+	if (time % interval == 0){
+		samples.push_back(resident);
+	}
+}
+
+void ResidentSetTrace::report(string type, string measure){
+	cout << type << " " << measure << ": mean " << (references ? (double) total / references : 0.0)
+		<< ", peak " << peak << ", every " << interval << " references:";
+
+	for (size_t i = 0; i < samples.size(); ++i){
+		cout << " " << samples[i];
+	}
+	cout << endl;
+}
+
+/*
+ * The working set policy. Every resident page carries its last-use virtual time
+ * in the auxiliary column of the frame table, and resident pages are kept in a
+ * list ordered by that time. After each reference the pages at the old end of
+ * the list whose last use is tau or more references ago leave the working set
+ * and their frames go back on the free frame list.
+ *
+ * If the working set outgrows the frames the engine was given, the least
+ * recently used page is replaced as a fallback.
+ */
+WSEngine::WSEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, int tau)
+	: Engine("WS", page_table, frame_table, free_frame_list), lists(1, max_page_frames), tau(tau), resident(WS_SAMPLE_INTERVAL){
+}
+
+int WSEngine::reference(int page, int write){
+	int faulted = Engine::reference(page, write);
+
+	while (lists.tail[0] != -1 && time - frame_table[lists.tail[0]][1] >= tau){
+		int frame = lists.tail[0];
+
+		lists.remove(frame);
+		discard(frame);
+		free_frame_list.push_back(frame);
+	}
+
+	resident.record(time, lists.size[0]);
+
+	return faulted;
+}
+
+void WSEngine::report(){
+	Engine::report();
+	resident.report(type);
+}
+
+void WSEngine::hit(int page, int frame){
+	frame_table[frame][1] = time;
+
+	lists.remove(frame);
+	lists.pushFront(0, frame);
+}
+
+void WSEngine::load(int page, int frame){
+	frame_table[frame][1] = time;
+	lists.pushFront(0, frame);
+}
+
+int WSEngine::victim(){
+	int frame = lists.tail[0];
+	lists.remove(frame);
+
+	return frame;
+}
+
+/*
+ * WSClock as described by Carr and Hennessy. A hit only sets the referenced bit
+ * of the page, kept in the auxiliary column of the page table. On a fault the
+ * hand advances around the frames: a referenced page has its bit cleared and
+ * its last-use time, kept in the auxiliary column of the frame table, set to
+ * now, and the hand moves on. The first unreferenced page whose last use is tau
+ * or more references ago has left the working set; the hand stops there and
+ * the faulting page takes its frame. Only when a whole pass finds no such page
+ * does the faulting page take a free frame, or failing that replace the page
+ * with the oldest last use.
+ */
+WSClockEngine::WSClockEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, int tau)
+	: Engine("WSClock", page_table, frame_table, free_frame_list), tau(tau), hand(0), working_set(WS_SAMPLE_INTERVAL),
+	  used_at(max_num_pages, -tau - 1), window(tau, -1), working(0), oldest(-1){
+}
+
+int WSClockEngine::reference(int page, int write){
+	int faulted = Engine::reference(page, write);
+
+	// The page referenced tau references ago leaves the working set, unless it
+	// has been referenced since or was evicted and already left it
+	int expired = window[time % tau];
+	if (expired != -1 && used_at[expired] == time - tau){
+		working--;
+	}
+
+	if (used_at[page] <= time - tau){
+		working++;
+	}
+	used_at[page] = time;
+	window[time % tau] = page;
+
+	working_set.record(time, working);
+
+	return faulted;
+}
+
+void WSClockEngine::report(){
+	Engine::report();
+	working_set.report(type, "working set");
+}
+
+// Takes the page in a frame that is about to be evicted out of the count
+void WSClockEngine::leaveWorkingSet(int frame){
+	int page = frame_table[frame][0];
+
+	if (page != -1 && used_at[page] >= time - tau){
+		working--;
+	}
+	if (page != -1){
+		used_at[page] = -tau - 1;
+	}
+}
+
+void WSClockEngine::fault(int page){
+	oldest = -1;
+
+	for (int i = 0; i < max_page_frames; ++i, hand = (hand + 1) % max_page_frames){
+		int resident_page = frame_table[hand][0];
+
+		if (resident_page == -1){
+			continue;
+		}
+
+		if (page_table[resident_page][2] == VALID_BIT){
+			page_table[resident_page][2] = INVALID_BIT;
+			frame_table[hand][1] = time;
+		} else if (time - frame_table[hand][1] >= tau){
+			leaveWorkingSet(hand);
+			discard(hand);
+			free_frame_list.push_back(hand);
+			hand = (hand + 1) % max_page_frames;
+			return;
+		}
+
+		if (oldest == -1 || frame_table[hand][1] < frame_table[oldest][1]){
+			oldest = hand;
+		}
+	}
+}
+
+void WSClockEngine::hit(int page, int frame){
+	page_table[page][2] = VALID_BIT;
+}
+
+void WSClockEngine::load(int page, int frame){
+	page_table[page][2] = INVALID_BIT;
+	frame_table[frame][1] = time;
+}
+
+int WSClockEngine::victim(){
+	// Evictions asked for outside of a fault have no sweep to go by
+	if (oldest == -1 || frame_table[oldest][0] == -1){
+		for (int i = 0; i < max_page_frames; ++i){
+			if (frame_table[i][0] != -1 && (oldest == -1 || frame_table[oldest][0] == -1 || frame_table[i][1] < frame_table[oldest][1])){
+				oldest = i;
+			}
+		}
+	}
+
+	int frame = oldest;
+	oldest = -1;
+
+	leaveWorkingSet(frame);
+
+	return frame;
+}
+
+/*
+ * Creates the engine that goes by the given name, working on the given tables.
+ * "LRU" is LRU-K with K = 1 and no correlated period, which is exactly LRU, and
+ * "LRU-K" is LRU-K with the default K. Random policies are seeded with seed, and
+ * OPT, alone or under PFF, can only be built from the references it will be
+ * fed, wherever in memory they are. Returns NULL for a name it does not know.
+ */
+Engine *createEngine(string type, int page_table[][3], int frame_table[][2], vector<int> free_frame_list,
+		const int *pages, int references, uint64_t seed){
+	transform(type.begin(), type.end(), type.begin(), toupper);
+
+	if (type == "FIFO"){
+		// The usual small allocations get a FIFO with its queue sized at
+		// compile time
+		if (free_frame_list.size() > 0 && free_frame_list.size() <= 16){
+			return new FixedFIFOEngine<16>(page_table, frame_table, free_frame_list);
+		} else if (free_frame_list.size() > 0 && free_frame_list.size() <= 64){
+			return new FixedFIFOEngine<64>(page_table, frame_table, free_frame_list);
+		} else if (free_frame_list.size() > 0 && free_frame_list.size() <= 256){
+			return new FixedFIFOEngine<256>(page_table, frame_table, free_frame_list);
+		}
+		return new FIFOEngine(page_table, frame_table, free_frame_list);
+	} else if (type == "LRU"){
+		Engine *engine = new LRUKEngine(page_table, frame_table, free_frame_list, 1, 0, LRU_K_RETAINED_PERIOD);
+		engine->type = "LRU";
+		return engine;
+	} else if (type == "LRU-K"){
+		return new LRUKEngine(page_table, frame_table, free_frame_list, LRU_K, LRU_K_CORRELATED_PERIOD, LRU_K_RETAINED_PERIOD);
+	} else if (type.compare(0, 4, "LRU-") == 0 && atoi(type.c_str() + 4) > 0){
+		return new LRUKEngine(page_table, frame_table, free_frame_list, atoi(type.c_str() + 4), LRU_K_CORRELATED_PERIOD, LRU_K_RETAINED_PERIOD);
+	} else if (type == "S3-FIFO"){
+		return new S3FIFOEngine(page_table, frame_table, free_frame_list);
+	} else if (type == "SIEVE"){
+		return new SIEVEEngine(page_table, frame_table, free_frame_list);
+	} else if (type == "W-TINYLFU"){
+		return new WTinyLFUEngine(page_table, frame_table, free_frame_list);
+	} else if (type == "WS"){
+		return new WSEngine(page_table, frame_table, free_frame_list, WS_TAU);
+	} else if (type == "WSCLOCK"){
+		return new WSClockEngine(page_table, frame_table, free_frame_list, WS_TAU);
+	} else if (type == "NRU"){
+		return new NRUEngine(page_table, frame_table, free_frame_list, NRU_CLEAR_INTERVAL, seed);
+	} else if (type == "MQ"){
+		return new MQEngine(page_table, frame_table, free_frame_list, MQ_LIFE_TIME);
+	} else if (type == "CLOCK-PRO"){
+		return new ClockProEngine(page_table, frame_table, free_frame_list);
+	} else if (type.compare(0, 8, "SAMPLED-") == 0){
+		return new SampledEngine(page_table, frame_table, free_frame_list, type.substr(8), SAMPLED_K, seed);
+	} else if (type == "PFF" || type.compare(0, 4, "PFF-") == 0){
+		// PFF only sizes the allocation, so any policy can run underneath it;
+		// the base engine starts with no frames and is handed them by PFF
+		Engine *base = createEngine(type == "PFF" ? PFF_BASE : type.substr(4), page_table, frame_table, vector<int>(), pages, references, seed);
+		return base != NULL ? new PFFEngine(page_table, frame_table, free_frame_list, base) : NULL;
+	} else if (type == "MRU"){
+		return new MRUEngine(page_table, frame_table, free_frame_list);
+	} else if (type == "RAN" || type == "RAN2"){
+		return new RANEngine(page_table, frame_table, free_frame_list, type, seed);
+	} else if (type == "OPT" && pages != NULL){
+		return new OPTEngine(page_table, frame_table, free_frame_list, pages, references);
+	}
+
+	return NULL;
+}
+
+/*
+ * Page-fault frequency as described by Chu and Opderbeck. On every fault the
+ * time since the previous fault is compared against two thresholds. A process
+ * faulting more often than the lower one is short of memory and is given a
+ * frame from the pool. A process faulting less often than the upper one holds
+ * more than it needs and gives back as many frames as it holds pages that were
+ * not referenced since the previous fault. Frames are given back from the base
+ * engine's free frames first and then by having the base engine evict pages of
+ * its choosing, so the base engine's policy decides what leaves memory.
+ */
+PFFEngine::PFFEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, Engine *base)
+	: Engine("PFF", page_table, frame_table, free_frame_list), base(base), allocation(0), last_fault(0), resident(WS_SAMPLE_INTERVAL),
+	  referenced_after(max_num_pages, -1), distinct(0){
+	type = "PFF(" + base->type + ")";
+
+	while (allocation < PFF_INITIAL_FRAMES && this->free_frame_list.size() > 0){
+		grow();
+	}
+}
+
+PFFEngine::~PFFEngine(){
+	delete base;
+}
+
+int PFFEngine::reference(int page, int write){
+	++time;
+
+	if (!base->isResident(page)){
+		int interval = time - last_fault;
+
+		if (interval < PFF_LOWER_INTERVAL && free_frame_list.size() > 0){
+			grow();
+		} else if (interval > PFF_UPPER_INTERVAL){
+			shrink(allocation - distinct);
+		}
+
+		last_fault = time;
+		distinct = 0;
+	}
+
+	if (referenced_after[page] != last_fault){
+		referenced_after[page] = last_fault;
+		distinct++;
+	}
+
+	int faulted = base->reference(page, write);
+	fault_rate += faulted;
+
+	resident.record(time, allocation);
+
+	return faulted;
+}
+
+void PFFEngine::report(){
+	Engine::report();
+	resident.report(type);
+}
+
+int PFFEngine::victim(){
+	return base->evict();
+}
+
+void PFFEngine::grow(){
+	base->free_frame_list.push_back(free_frame_list.back());
+	free_frame_list.pop_back();
+
+	base->resize(++allocation);
+}
+
+void PFFEngine::shrink(int count){
+	while (count-- > 0 && allocation > PFF_MIN_FRAMES){
+		int frame;
+
+		if (base->free_frame_list.size() > 0){
+			frame = base->free_frame_list.back();
+			base->free_frame_list.pop_back();
+		} else {
+			frame = base->evict();
+		}
+
+		free_frame_list.push_back(frame);
+		--allocation;
+	}
+
+	base->resize(allocation);
+}
+
+/*
+ * Not recently used. The referenced and modified bits of each page are kept in
+ * the auxiliary column of the page table as a number from 0 to 3, which is also
+ * the page's class: 0 is neither referenced nor modified, 1 modified only, 2
+ * referenced only and 3 both. Every reference sets the referenced bit and every
+ * write the modified bit. Every clear_interval references the referenced bits
+ * of all resident pages are cleared, which moves classes 2 and 3 down to 0 and
+ * 1 wholesale.
+ *
+ * Evicting a page whose modified bit is set costs a write-back, and the number
+ * of those is reported alongside the faults.
+ */
+NRUEngine::NRUEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, int clear_interval,
+		uint64_t seed)
+	: Engine("NRU", page_table, frame_table, free_frame_list), clear_interval(clear_interval), writebacks(0), random(seed){
+	for (int c = 0; c < 4; ++c){
+		classes[c].assign((max_page_frames + 63) / 64, 0);
+	}
+}
+
+int NRUEngine::reference(int page, int write){
+	int faulted = Engine::reference(page, write);
+
+	if (time % clear_interval == 0){
+		for (size_t w = 0; w < classes[0].size(); ++w){
+			uint64_t referenced = classes[REFERENCED][w] | classes[REFERENCED | MODIFIED][w];
+
+			// Only the pages that had the bit set need their page table entry
+			// touched
+			while (referenced){
+				int frame = w * 64 + __builtin_ctzll(referenced);
+				referenced &= referenced - 1;
+
+				page_table[frame_table[frame][0]][2] &= MODIFIED;
+			}
+
+			classes[0][w] |= classes[REFERENCED][w];
+			classes[MODIFIED][w] |= classes[REFERENCED | MODIFIED][w];
+			classes[REFERENCED][w] = 0;
+			classes[REFERENCED | MODIFIED][w] = 0;
+		}
+	}
+
+	return faulted;
+}
+
+void NRUEngine::report(){
+	Engine::report();
+	cout << type << " write-backs: " << writebacks << endl;
+}
+
+void NRUEngine::setClass(int page, int frame, int bits){
+	uint64_t bit = 1ULL << (frame & 63);
+
+	classes[page_table[page][2]][frame >> 6] &= ~bit;
+	classes[bits][frame >> 6] |= bit;
+	page_table[page][2] = bits;
+}
+
+void NRUEngine::hit(int page, int frame){
+	setClass(page, frame, page_table[page][2] | REFERENCED | (writing ? MODIFIED : 0));
+}
+
+void NRUEngine::load(int page, int frame){
+	page_table[page][2] = 0;
+	setClass(page, frame, REFERENCED | (writing ? MODIFIED : 0));
+}
+
+int NRUEngine::victim(){
+	for (int c = 0; c < 4; ++c){
+		int members = 0;
+
+		for (size_t w = 0; w < classes[c].size(); ++w){
+			members += __builtin_popcountll(classes[c][w]);
+		}
+
+		if (members == 0){
+			continue;
+		}
+
+		// Walk to the chosen member a word at a time, then clear the lower
+		// set bits of its word until it is the lowest one left
+		int chosen = random.next() % members;
+		size_t w = 0;
+
+		while (__builtin_popcountll(classes[c][w]) <= chosen){
+			chosen -= __builtin_popcountll(classes[c][w]);
+			++w;
+		}
+
+		uint64_t word = classes[c][w];
+		while (chosen-- > 0){
+			word &= word - 1;
+		}
+
+		int frame = w * 64 + __builtin_ctzll(word);
+
+		classes[c][w] &= ~(1ULL << (frame & 63));
+		if (c & MODIFIED){
+			writebacks++;
+		}
+
+		return frame;
+	}
+
+	return 0;
+}
+
+static inline uint64_t splitmix64(uint64_t &state){
+	uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/*
+ * The state is filled from the seed with splitmix64, as the authors recommend,
+ * so that nearby seeds still give unrelated streams
+ */
+Random::Random(uint64_t seed){
+	for (int i = 0; i < 4; ++i){
+		s[i] = splitmix64(seed);
+	}
+}
+
+uint64_t Random::next(){
+	uint64_t result = s[1] * 5;
+	result = ((result << 7) | (result >> 57)) * 9;
+
+	uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = (s[3] << 45) | (s[3] >> 19);
+
+	return result;
+}
+
+double Random::uniform(){
+	return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+ResidentFrames::ResidentFrames() : position(max_page_frames, -1){
+}
+
+void ResidentFrames::insert(int frame){
+	if (position[frame] == -1){
+		position[frame] = frames.size();
+		frames.push_back(frame);
+	}
+}
+
+void ResidentFrames::erase(int frame){
+	int index = position[frame];
+
+	frames[index] = frames.back();
+	position[frames[index]] = index;
+	frames.pop_back();
+	position[frame] = -1;
+}
+
+/*
+ * Random replacement over the frames the engine holds. RAN scales a uniformly
+ * distributed number onto the resident frames and RAN2 takes a random number
+ * modulo their count, the same two schemes RAN() used to compare with rand().
+ */
+RANEngine::RANEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, string type, uint64_t seed)
+	: Engine(type, page_table, frame_table, free_frame_list), random(seed){
+}
+
+void RANEngine::load(int page, int frame){
+	resident.insert(frame);
+}
+
+int RANEngine::victim(){
+	int index;
+
+	if (type == "RAN"){
+		index = random.uniform() * resident.size();
+	} else {
+		index = random.next() % resident.size();
+	}
+
+	// The frame leaves the set here and load() puts it back once the
+	// faulting page occupies it
+	int frame = resident.frames[index];
+	resident.erase(frame);
+
+	return frame;
+}
+
+/*
+ * Two-sided 95% critical values of Student's t distribution for 1 to 30 degrees
+ * of freedom; past that the normal value is close enough
+ */
+static double tCritical(int degrees){
+	static const double table[30] = {
+		12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+		2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+		2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+	};
+
+	return degrees <= 30 ? table[degrees - 1] : 1.960;
+}
+
+/*
+ * Runs a random algorithm over the same in-memory reference string once per
+ * seed, spreading the runs over the cores, and reports the mean, standard
+ * deviation and 95% confidence interval of the faults. Run r is seeded with
+ * random_seed + r, so the whole experiment can be repeated with --seed.
+ */
+void monteCarlo(string type, const Trace &trace, int runs){
+	vector<int> faults(runs, 0);
+	atomic<int> next_run(0);
+
+	int workers = std::min(runs, std::max(1, std::min((int) thread::hardware_concurrency(), MAX_THREADS)));
+	vector<thread> threads;
+
+	for (int w = 0; w < workers; ++w){
+		threads.push_back(thread([&](){
+			vector<int> page_table(max_num_pages * 3);
+			vector<int> frame_table(max_page_frames * 2);
+			vector<int> free_frame_list;
+
+			int (*pages)[3] = (int (*)[3]) &page_table[0];
+			int (*frames)[2] = (int (*)[2]) &frame_table[0];
+
+			for (int run = next_run++; run < runs; run = next_run++){
+				resetTables(pages, frames, free_frame_list);
+				RANEngine engine(pages, frames, free_frame_list, type, random_seed + run);
+
+				for (size_t i = 0; i < trace.pages.size(); ++i){
+					engine.reference(trace.pages[i], trace.writes[i]);
+				}
+
+				faults[run] = engine.fault_rate;
+			}
+		}));
+	}
+
+	for (size_t w = 0; w < threads.size(); ++w){
+		threads[w].join();
+	}
+
+	double mean = 0;
+	for (int run = 0; run < runs; ++run){
+		mean += faults[run];
+	}
+	mean /= runs;
+
+	double variance = 0;
+	for (int run = 0; run < runs; ++run){
+		variance += (faults[run] - mean) * (faults[run] - mean);
+	}
+	variance /= runs - 1;
+
+	double stdev = sqrt(variance);
+	double margin = tCritical(runs - 1) * stdev / sqrt((double) runs);
+
+	cout << type << ": mean " << mean << ", stdev " << stdev << ", 95% CI [" << mean - margin << ", "
+		<< mean + margin << "] over " << runs << " seeds" << endl;
+}
+
+/*
+ * CLOCK-Pro as described by Jiang, Chen and Zhang. Resident pages are hot or
+ * cold, and a cold page that is evicted stays on the list as a non-resident
+ * test page for a while. A hit only sets the page's referenced bit.
+ *
+ * On a fault, HAND_cold sweeps the list for a cold page. A referenced cold page
+ * was reused within its test period, so it is promoted to hot; an unreferenced
+ * one is evicted and becomes a test page. Whenever there are more hot pages than
+ * frames - cold_target, HAND_hot sweeps the list demoting hot pages that were
+ * not referenced since it last passed, and whenever there are more test pages
+ * than frames, HAND_test sweeps the list dropping the oldest test pages.
+ *
+ * A faulting page that is still a test page would have been a hit with more
+ * cold frames, so cold_target grows and the page comes back hot; a test page
+ * that HAND_test drops was never reused, so cold_target shrinks. Every sweep
+ * step is constant work, so a reference costs what it does under CLOCK.
+ *
+ * All cold resident pages are treated as being in their test period, as in the
+ * authors' reference simulator, and cold_target starts at half the frames.
+ */
+ClockProEngine::ClockProEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list)
+	: Engine("CLOCK-Pro", page_table, frame_table, free_frame_list), node_page(2 * max_page_frames + 1), node_status(2 * max_page_frames + 1),
+	  node_referenced(2 * max_page_frames + 1), next(2 * max_page_frames + 1), prev(2 * max_page_frames + 1), node_of(max_num_pages, -1),
+	  hand_hot(-1), hand_cold(-1), hand_test(-1), count_hot(0), count_cold(0), count_test(0), returning(0){
+	for (int i = 2 * max_page_frames; i >= 0; --i){
+		free_nodes.push_back(i);
+	}
+
+	cold_target = std::max(1, frames / 2);
+}
+
+void ClockProEngine::resize(int frames){
+	Engine::resize(frames);
+	cold_target = std::max(1, std::min(cold_target, frames));
+}
+
+void ClockProEngine::fault(int page){
+	int node = node_of[page];
+	returning = 0;
+
+	if (node != -1 && node_status[node] == TEST){
+		returning = 1;
+		if (cold_target < frames){
+			cold_target++;
+		}
+
+		remove(node);
+		count_test--;
+	}
+}
+
+void ClockProEngine::hit(int page, int frame){
+	node_referenced[node_of[page]] = 1;
+}
+
+void ClockProEngine::load(int page, int frame){
+	if (returning){
+		insert(page, HOT);
+		count_hot++;
+
+		while (count_hot > frames - cold_target){
+			runHandHot();
+		}
+	} else {
+		insert(page, COLD);
+		count_cold++;
+	}
+}
+
+int ClockProEngine::victim(){
+	int frame = -1;
+
+	while (frame == -1){
+		// After the allocation shrinks, or after HAND_cold promoted the last
+		// cold page, every resident page can be hot, and HAND_cold needs a
+		// cold page to find
+		while (count_cold == 0){
+			runHandHot();
+		}
+
+		frame = runHandCold();
+	}
+
+	return frame;
+}
+
+/*
+ * Puts a page on the list just behind HAND_hot, which makes it the page all
+ * three hands reach last
+ */
+void ClockProEngine::insert(int page, int status){
+	int node = free_nodes.back();
+	free_nodes.pop_back();
+
+	node_page[node] = page;
+	node_status[node] = status;
+	node_referenced[node] = 0;
+	node_of[page] = node;
+
+	if (hand_hot == -1){
+		next[node] = prev[node] = node;
+		hand_hot = hand_cold = hand_test = node;
+		return;
+	}
+
+	next[node] = hand_hot;
+	prev[node] = prev[hand_hot];
+	next[prev[hand_hot]] = node;
+	prev[hand_hot] = node;
+}
+
+void ClockProEngine::remove(int node){
+	int after = next[node] != node ? next[node] : -1;
+
+	if (hand_hot == node) hand_hot = after;
+	if (hand_cold == node) hand_cold = after;
+	if (hand_test == node) hand_test = after;
+
+	next[prev[node]] = next[node];
+	prev[next[node]] = prev[node];
+
+	node_of[node_page[node]] = -1;
+	free_nodes.push_back(node);
+}
+
+/*
+ * Moves HAND_cold one step and returns the frame it freed, or -1
+ */
+int ClockProEngine::runHandCold(){
+	int node = hand_cold;
+	int frame = -1;
+
+	hand_cold = next[node];
+
+	if (node_status[node] != COLD){
+		return -1;
+	}
+
+	int page = node_page[node];
+
+	if (node_referenced[node]){
+		node_referenced[node] = 0;
+		node_status[node] = HOT;
+		count_cold--;
+		count_hot++;
+
+		while (count_hot > frames - cold_target){
+			runHandHot();
+		}
+
+		return -1;
+	}
+
+	frame = page_table[page][0];
+	node_status[node] = TEST;
+	count_cold--;
+	count_test++;
+
+	while (count_test > frames){
+		runHandTest();
+	}
+
+	return frame;
+}
+
+void ClockProEngine::runHandHot(){
+	int node = hand_hot;
+
+	hand_hot = next[node];
+
+	if (node_status[node] == HOT){
+		if (node_referenced[node]){
+			node_referenced[node] = 0;
+		} else {
+			node_status[node] = COLD;
+			count_hot--;
+			count_cold++;
+		}
+	}
+}
+
+void ClockProEngine::runHandTest(){
+	int node = hand_test;
+
+	hand_test = next[node];
+
+	if (node_status[node] == TEST){
+		remove(node);
+		count_test--;
+
+		if (cold_target > 1){
+			cold_target--;
+		}
+	}
+}
+
+/*
+ * Multi-Queue as described by Zhou, Philbin and Li. A page referenced f times
+ * sits in LRU queue min(log2(f), MQ_QUEUES - 1), with its reference count in the
+ * auxiliary column of the frame table. Each reference gives the page a new
+ * expiration time life_time references ahead, and on every reference the least
+ * recently used page of each queue is checked: if it has expired it moves down
+ * one queue and gets a new expiration time. The victim is the least recently
+ * used page of the lowest non-empty queue.
+ *
+ * Evicted pages go into Qout with their reference count, so a page that comes
+ * back before it falls out of Qout resumes its count instead of starting at
+ * the bottom. Every operation touches a constant number of list nodes.
+ */
+MQEngine::MQEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list, int life_time)
+	: Engine("MQ", page_table, frame_table, free_frame_list), queues(MQ_QUEUES, max_page_frames), expire(max_page_frames, 0),
+	  life_time(life_time), qout(MQ_QOUT_FACTOR * max_page_frames), qout_stamp(max_num_pages, 0), qout_frequency(max_num_pages, 0){
+}
+
+/*
+ * Puts a frame at the most recently used end of the queue its reference count
+ * calls for
+ */
+void MQEngine::enqueue(int frame){
+	int queue = 0;
+
+	for (int frequency = frame_table[frame][1]; frequency > 1 && queue < MQ_QUEUES - 1; frequency >>= 1){
+		queue++;
+	}
+
+	queues.pushFront(queue, frame);
+	expire[frame] = time + life_time;
+}
+
+void MQEngine::adjust(){
+	for (int queue = 1; queue < MQ_QUEUES; ++queue){
+		int frame = queues.tail[queue];
+
+		if (frame != -1 && expire[frame] < time){
+			queues.remove(frame);
+			queues.pushFront(queue - 1, frame);
+			expire[frame] = time + life_time;
+		}
+	}
+}
+
+void MQEngine::hit(int page, int frame){
+	frame_table[frame][1]++;
+
+	queues.remove(frame);
+	enqueue(frame);
+	adjust();
+}
+
+void MQEngine::load(int page, int frame){
+	unsigned int stamp = qout_stamp[page];
+
+	if (stamp != 0 && stamp - 1 - qout.head < (unsigned int) qout.size()){
+		frame_table[frame][1] = qout_frequency[page] + 1;
+		qout_stamp[page] = 0;
+	} else {
+		frame_table[frame][1] = 1;
+	}
+
+	enqueue(frame);
+	adjust();
+}
+
+int MQEngine::victim(){
+	int queue = 0;
+
+	while (queues.tail[queue] == -1){
+		queue++;
+	}
+
+	int frame = queues.tail[queue];
+	int page = frame_table[frame][0];
+
+	queues.remove(frame);
+
+	if (qout.size() >= std::max(1, MQ_QOUT_FACTOR * frames)){
+		qout.pop();
+	}
+	qout_stamp[page] = qout.tail + 1;
+	qout_frequency[page] = frame_table[frame][1];
+	qout.push(page);
+
+	return frame;
+}
+
+/*
+ * Priority functions for sampled eviction. LRU ranks a page by the time of its
+ * last reference, LFU by how often it was referenced, and hyperbolic caching
+ * (Blankstein, Sen and Freedman) by how often it was referenced per reference
+ * since it was loaded, so that a page that was popular long ago loses out to
+ * one that is popular now.
+ */
+static double sampledLRU(const SampledEngine &engine, int frame){
+	return engine.frame_table[frame][1];
+}
+
+static double sampledLFU(const SampledEngine &engine, int frame){
+	return engine.count[frame];
+}
+
+static double sampledHyperbolic(const SampledEngine &engine, int frame){
+	return (double) engine.count[frame] / (engine.time - engine.loaded[frame] + 1);
+}
+
+/*
+ * Sampled eviction, the way Redis evicts keys. Hits and loads only update the
+ * frame's counters, so they are constant time, and an eviction draws k resident
+ * frames at random and evicts the one with the lowest priority, so it costs O(k)
+ * no matter how many frames there are. The larger k is, the closer the engine
+ * gets to the exact policy its priority function describes.
+ */
+SampledEngine::SampledEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list,
+		string priority, int k, uint64_t seed)
+	: Engine("", page_table, frame_table, free_frame_list), k(k), random(seed), count(max_page_frames, 0), loaded(max_page_frames, 0){
+	transform(priority.begin(), priority.end(), priority.begin(), toupper);
+
+	const char *scheme = "LRU";
+
+	if (priority == "LFU"){
+		this->priority = sampledLFU;
+		scheme = "LFU";
+	} else if (priority == "HYPERBOLIC"){
+		this->priority = sampledHyperbolic;
+		scheme = "Hyperbolic";
+	} else {
+		this->priority = sampledLRU;
+	}
+
+	char name[64];
+	sprintf(name, "Sampled-%s(K=%d)", scheme, k);
+	type = name;
+}
+
+void SampledEngine::hit(int page, int frame){
+	frame_table[frame][1] = time;
+	count[frame]++;
+}
+
+void SampledEngine::load(int page, int frame){
+	frame_table[frame][1] = time;
+	count[frame] = 1;
+	loaded[frame] = time;
+
+	resident.insert(frame);
+}
+
+int SampledEngine::victim(){
+	int victim = -1;
+	double lowest = 0;
+
+	for (int i = 0; i < k; ++i){
+		int frame = resident.frames[random.next() % resident.size()];
+		double rank = priority(*this, frame);
+
+		if (victim == -1 || rank < lowest){
+			victim = frame;
+			lowest = rank;
+		}
+	}
+
+	resident.erase(victim);
+
+	return victim;
+}
+
+/*
+ * FIFO over whatever frames the engine was given. The frames are queued in the
+ * order pages were loaded into them, so the victim is always the front of the
+ * queue and the number of frames is only the length of the free frame list.
+ */
+FIFOEngine::FIFOEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list)
+	: Engine("FIFO", page_table, frame_table, free_frame_list), loaded(max_page_frames){
+}
+
+void FIFOEngine::load(int page, int frame){
+	loaded.push(frame);
+}
+
+int FIFOEngine::victim(){
+	return loaded.pop();
+}
+
+// Keeps the label the FIFO line has always been printed with
+void FIFOEngine::report(){
+	cout << "FIFO :" << fault_rate << endl;
+}
+
+template<int FRAMES> FixedFIFOEngine<FRAMES>::FixedFIFOEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list)
+	: Engine("FIFO", page_table, frame_table, free_frame_list), head(0), tail(0){
+}
+
+/*
+ * Engine::reference() with FIFO's hit, load and victim written in place
+ */
+template<int FRAMES> int FixedFIFOEngine<FRAMES>::reference(int page, int write){
+	++time;
+	writing = write;
+
+	int frame = page_table[page][0];
+	if (page_table[page][1] == VALID_BIT && frame_table[frame][0] == page){
+		return 0;
+	}
+
+	if (free_frame_list.size() == 0){
+		frame = loaded[head++ & (FRAMES - 1)];
+		discard(frame);
+	} else {
+		frame = free_frame_list.back();
+		free_frame_list.pop_back();
+	}
+
+	page_table[page][0] = frame;
+	page_table[page][1] = VALID_BIT;
+	frame_table[frame][0] = page;
+
+	loaded[tail++ & (FRAMES - 1)] = frame;
+	fault_rate++;
+
+	return 1;
+}
+
+template<int FRAMES> void FixedFIFOEngine<FRAMES>::load(int page, int frame){
+	loaded[tail++ & (FRAMES - 1)] = frame;
+}
+
+template<int FRAMES> int FixedFIFOEngine<FRAMES>::victim(){
+	return loaded[head++ & (FRAMES - 1)];
+}
+
+template<int FRAMES> void FixedFIFOEngine<FRAMES>::report(){
+	cout << "FIFO :" << fault_rate << endl;
+}
+
+template<int FRAMES> void FixedFIFOEngine<FRAMES>::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	c.field(loaded);
+	c.field(head);
+	c.field(tail);
+}
+
+MRUEngine::MRUEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list)
+	: Engine("MRU", page_table, frame_table, free_frame_list), order(1, max_page_frames){
+}
+
+void MRUEngine::hit(int page, int frame){
+	order.remove(frame);
+	order.pushFront(0, frame);
+}
+
+void MRUEngine::load(int page, int frame){
+	order.pushFront(0, frame);
+}
+
+int MRUEngine::victim(){
+	int frame = order.head[0];
+	order.remove(frame);
+
+	return frame;
+}
+
+/*
+ * OPT with the next reference of every position worked out in one backward
+ * pass, so a fault pops a heap instead of scanning the rest of the reference
+ * string for every frame the way identifyPageToRemove() does
+ */
+OPTEngine::OPTEngine(int page_table[][3], int frame_table[][2], vector<int> free_frame_list,
+		const int *pages, int references)
+	: Engine("OPT", page_table, frame_table, free_frame_list), next_use(references), next(max_page_frames, 0){
+	vector<int> seen(max_num_pages, references);
+
+	for (int i = references - 1; i >= 0; --i){
+		next_use[i] = seen[pages[i]];
+		seen[pages[i]] = i;
+	}
+}
+
+void OPTEngine::hit(int page, int frame){
+	next[frame] = next_use[time - 1];
+	heap.push(HeapEntry(next[frame], frame));
+}
+
+void OPTEngine::load(int page, int frame){
+	hit(page, frame);
+}
+
+int OPTEngine::victim(){
+	while (!heap.empty()){
+		HeapEntry top = heap.top();
+		heap.pop();
+
+		if (next[top.second] == top.first && frame_table[top.second][0] != -1){
+			return top.second;
+		}
+	}
+
+	return 0;
+}
+
+void Checkpoint::block(void *data, size_t size){
+	if (!loading){
+		bytes.append((const char *) data, size);
+		return;
+	}
+
+	if (failed || size > bytes.size() - position){
+		failed = 1;
+		return;
+	}
+
+	memcpy(data, bytes.data() + position, size);
+	position += size;
+}
+
+void Checkpoint::field(string &value){
+	vector<char> characters(value.begin(), value.end());
+	field(characters);
+	value.assign(characters.begin(), characters.end());
+}
+
+/*
+ * Every engine's checkpoint holds what its constructor cannot work out again:
+ * the tables, the common counters and the policy's own structures, including
+ * the state of its random number generator. Parameters fixed at construction
+ * are not saved, so a checkpoint is loaded into an engine built the same way.
+ */
+void Engine::checkpoint(Checkpoint &c){
+	c.block(page_table, max_num_pages * sizeof(page_table[0]));
+	c.block(frame_table, max_page_frames * sizeof(frame_table[0]));
+	checkpointState(c);
+}
+
+void Engine::checkpointState(Checkpoint &c){
+	c.field(free_frame_list);
+	c.field(frames);
+	c.field(fault_rate);
+	c.field(time);
+	c.field(writing);
+}
+
+void RingBuffer::checkpoint(Checkpoint &c){
+	c.field(slots);
+	c.field(mask);
+	c.field(head);
+	c.field(tail);
+}
+
+void FrameLists::checkpoint(Checkpoint &c){
+	c.field(prev);
+	c.field(next);
+	c.field(list);
+	c.field(head);
+	c.field(tail);
+	c.field(size);
+}
+
+void FrequencySketch::checkpoint(Checkpoint &c){
+	c.field(table);
+	c.field(doorkeeper);
+	c.field(counter_bits);
+	c.field(doorkeeper_mask);
+	c.field(additions);
+	c.field(sample_size);
+}
+
+void ResidentSetTrace::checkpoint(Checkpoint &c){
+	c.field(samples);
+	c.field(total);
+	c.field(references);
+	c.field(peak);
+}
+
+void ResidentFrames::checkpoint(Checkpoint &c){
+	c.field(frames);
+	c.field(position);
+}
+
+void LRUKEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	c.field(hist);
+	c.field(last);
+	c.field(heap);
+	c.field(stamp);
+}
+
+void S3FIFOEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	small_fifo.checkpoint(c);
+	main_fifo.checkpoint(c);
+	ghost_fifo.checkpoint(c);
+	c.field(small_target);
+	c.field(ghost_capacity);
+	c.field(ghost_stamp);
+}
+
+void SIEVEEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	c.field(prev);
+	c.field(next);
+	c.field(head);
+	c.field(tail);
+	c.field(hand);
+}
+
+void WTinyLFUEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	lists.checkpoint(c);
+	sketch.checkpoint(c);
+	c.field(window_capacity);
+	c.field(protected_capacity);
+}
+
+void WSEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	lists.checkpoint(c);
+	resident.checkpoint(c);
+}
+
+void WSClockEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	c.field(hand);
+	working_set.checkpoint(c);
+	c.field(used_at);
+	c.field(window);
+	c.field(working);
+	c.field(oldest);
+}
+
+void PFFEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	base->checkpointState(c);
+	c.field(allocation);
+	c.field(last_fault);
+	resident.checkpoint(c);
+	c.field(referenced_after);
+	c.field(distinct);
+}
+
+void NRUEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	for (int i = 0; i < 4; ++i){
+		c.field(classes[i]);
+	}
+	c.field(writebacks);
+	c.field(random.s);
+}
+
+void RANEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	c.field(random.s);
+	resident.checkpoint(c);
+}
+
+void ClockProEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	c.field(node_page);
+	c.field(node_status);
+	c.field(node_referenced);
+	c.field(next);
+	c.field(prev);
+	c.field(free_nodes);
+	c.field(node_of);
+	c.field(hand_hot);
+	c.field(hand_cold);
+	c.field(hand_test);
+	c.field(count_hot);
+	c.field(count_cold);
+	c.field(count_test);
+	c.field(cold_target);
+	c.field(returning);
+}
+
+void MQEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	queues.checkpoint(c);
+	c.field(expire);
+	qout.checkpoint(c);
+	c.field(qout_stamp);
+	c.field(qout_frequency);
+}
+
+void SampledEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	c.field(random.s);
+	resident.checkpoint(c);
+	c.field(count);
+	c.field(loaded);
+}
+
+void FIFOEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	loaded.checkpoint(c);
+}
+
+void MRUEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	order.checkpoint(c);
+}
+
+// next_use comes from the reference string the engine is built from
+void OPTEngine::checkpointState(Checkpoint &c){
+	Engine::checkpointState(c);
+	c.field(next);
+	c.field(heap);
+}
+
+/*
+ * Writes the state of a fused run's engines to a file: a header with the
+ * position in the reference string the engines have reached, then the name
+ * and checkpoint of each engine. The file is written beside the old one and
+ * renamed over it, so an interruption never leaves a torn checkpoint behind.
+ */
+void saveCheckpoint(string filename, vector<string> &types, vector<Engine *> &engines, int position){
+	Checkpoint header;
+	char magic[8] = { 'C', 'P', 'A', 'G', 'E', 'C', 'K', '3' };
+	uint64_t count = engines.size();
+
+	header.field(magic);
+	header.field(max_num_pages);
+	header.field(max_page_frames);
+	header.field(position);
+	header.field(count);
+
+	string temporary = filename + ".tmp";
+	ofstream out(temporary.c_str(), std::ios::binary);
+	out.write(header.bytes.data(), header.bytes.size());
+
+	for (size_t e = 0; e < engines.size(); ++e){
+		Checkpoint c;
+		c.field(types[e]);
+		engines[e]->checkpoint(c);
+
+		out.write(c.bytes.data(), c.bytes.size());
+	}
+
+	out.close();
+
+	if (!out.fail()){
+		rename(temporary.c_str(), filename.c_str());
+	}
+}
+
+/*
+ * Opens a checkpoint written by saveCheckpoint() and reads its header, leaving
+ * the engines to read their own state from it. Returns 0 if the file is
+ * missing, is not a checkpoint or was taken with tables of another size.
+ */
+int openCheckpoint(string filename, Checkpoint &state, int &position, uint64_t &count){
+	ifstream in(filename.c_str(), std::ios::binary);
+
+	if (!in.is_open()){
+		return 0;
+	}
+
+	std::stringstream contents;
+	contents << in.rdbuf();
+	state = Checkpoint(contents.str());
+
+	char magic[8];
+	int pages = 0, frames = 0;
+
+	state.field(magic);
+	state.field(pages);
+	state.field(frames);
+	state.field(position);
+	state.field(count);
+
+	// The tables in the checkpoint only fit tables of the same size
+	return !state.failed && memcmp(magic, "CPAGECK3", 8) == 0 && pages == max_num_pages && frames == max_page_frames;
+}
+
+/*
+ * Runs several algorithms over one in-memory reference string in a single
+ * pass. Instead of each algorithm rereading the whole trace, the trace is cut
+ * into blocks of FUSED_BLOCK references and every engine is fed a block in
+ * turn while it is still in cache. Each engine keeps its own tables, so the
+ * results are the same as running the algorithms one after another: the
+ * default comparison runs FIFO, LRU, MRU and the random policies on the same
+ * engines, and both OPTs evict the page used furthest in the future.
+ */
+void fusedRun(const vector<string> &types, const Trace &trace){
+	vector<string> names = types;
+	Checkpoint resume;
+	int position = 0;
+
+	// Resuming runs the algorithms the checkpoint holds, from where it was
+	// written
+	if (!resume_filename.empty()){
+		uint64_t count = 0;
+
+		if (!openCheckpoint(resume_filename, resume, position, count)){
+			cout << "Cannot resume from " << resume_filename << endl;
+			return;
+		}
+		names.assign(count, "");
+	}
+
+	size_t count = names.size();
+
+	vector<vector<int> > page_tables(count, vector<int>(max_num_pages * 3));
+	vector<vector<int> > frame_tables(count, vector<int>(max_page_frames * 2));
+	vector<string> running;
+	vector<Engine *> engines;
+
+	for (size_t e = 0; e < count; ++e){
+		int (*pages)[3] = (int (*)[3]) &page_tables[e][0];
+		int (*frames)[2] = (int (*)[2]) &frame_tables[e][0];
+		vector<int> free_frame_list;
+
+		if (resume.loading){
+			resume.field(names[e]);
+		}
+
+		resetTables(pages, frames, free_frame_list);
+		Engine *engine = createEngine(names[e], pages, frames, free_frame_list, trace.pages.data(), trace.pages.size());
+
+		if (engine == NULL){
+			cout << "Unknown policy: " << names[e] << endl;
+
+			// The rest of the checkpoint cannot be found without this engine
+			if (resume.loading){
+				resume.failed = 1;
+				break;
+			}
+			continue;
+		}
+
+		if (resume.loading){
+			engine->checkpoint(resume);
+		}
+
+		running.push_back(names[e]);
+		engines.push_back(engine);
+	}
+
+	if (resume.failed){
+		cout << "Cannot resume from " << resume_filename << endl;
+
+		for (size_t e = 0; e < engines.size(); ++e){
+			delete engines[e];
+		}
+		return;
+	}
+
+	size_t references = trace.pages.size();
+	size_t next_checkpoint = position + (size_t) checkpoint_interval;
+
+	for (size_t start = position; start < references; ){
+		size_t end = std::min(start + FUSED_BLOCK, references);
+
+		if (!checkpoint_filename.empty()){
+			end = std::min(end, next_checkpoint);
+		}
+
+		for (size_t e = 0; e < engines.size(); ++e){
+			Engine *engine = engines[e];
+
+			for (size_t i = start; i < end; ++i){
+				engine->reference(trace.pages[i], trace.writes[i]);
+			}
+		}
+
+		start = end;
+
+		if (!checkpoint_filename.empty() && start == next_checkpoint){
+			saveCheckpoint(checkpoint_filename, running, engines, start);
+			next_checkpoint += checkpoint_interval;
+		}
+	}
+
+	for (size_t e = 0; e < engines.size(); ++e){
+		engines[e]->report();
+		delete engines[e];
+	}
+}
+
+WorkStealingPool::WorkStealingPool(int workers, int tasks) : workers(workers){
+	for (int w = 0; w < workers; ++w){
+		for (int task = (long long) tasks * w / workers; task < (long long) tasks * (w + 1) / workers; ++task){
+			this->workers[w].tasks.push_back(task);
+		}
+	}
+}
+
+int WorkStealingPool::take(int w){
+	{
+		lock_guard<mutex> guard(workers[w].lock);
+
+		if (!workers[w].tasks.empty()){
+			int task = workers[w].tasks.back();
+			workers[w].tasks.pop_back();
+			return task;
+		}
+	}
+
+	// Steal the oldest task of the next worker that has one. Tasks are never
+	// added once the pool runs, so one empty round means there are none left.
+	for (size_t v = 1; v < workers.size(); ++v){
+		Worker &victim = workers[(w + v) % workers.size()];
+		lock_guard<mutex> guard(victim.lock);
+
+		if (!victim.tasks.empty()){
+			int task = victim.tasks.front();
+			victim.tasks.pop_front();
+			return task;
+		}
+	}
+
+	return -1;
+}
+
+void WorkStealingPool::run(std::function<void(int task)> body){
+	vector<thread> threads;
+
+	for (size_t w = 0; w < workers.size(); ++w){
+		threads.push_back(thread([this, w, &body](){
+			for (int task = take(w); task != -1; task = take(w)){
+				body(task);
+			}
+		}));
+	}
+
+	for (size_t w = 0; w < threads.size(); ++w){
+		threads[w].join();
+	}
+}
+
+/*
+ * Runs one algorithm over an in-memory reference string with the given number
+ * of frames and seed on tables of its own, so any number of these can run at
+ * once. Returns the faults, or -1 for an algorithm createEngine() does not
+ * know, and the name the engine goes by in name.
+ */
+int simulate(string policy, const Trace &trace, int frames, uint64_t seed, string *name){
+	return simulate(policy, trace.pages.data(), trace.writes.data(), trace.pages.size(), frames, seed, name);
+}
+
+/*
+ * The same over a reference string held anywhere in memory, such as a segment
+ * shared between processes
+ */
+int simulate(string policy, const int *pages, const char *writes, int references, int frames, uint64_t seed, string *name){
+	vector<int> page_table(max_num_pages * 3);
+	vector<int> frame_table(max_page_frames * 2);
+	vector<int> free_frame_list;
+
+	int (*page_rows)[3] = (int (*)[3]) &page_table[0];
+	int (*frame_rows)[2] = (int (*)[2]) &frame_table[0];
+
+	resetTables(page_rows, frame_rows, free_frame_list, frames);
+
+	Engine *engine = createEngine(policy, page_rows, frame_rows, free_frame_list, pages, references, seed);
+
+	if (name != NULL){
+		*name = engine == NULL ? policy : engine->type;
+	}
+
+	if (engine == NULL){
+		return -1;
+	}
+
+	for (int i = 0; i < references; ++i){
+		engine->reference(pages[i], writes[i]);
+	}
+
+	int faults = engine->fault_rate;
+	delete engine;
+
+	return faults;
+}
+
+/*
+ * Runs every combination of trace, algorithm, frame count and seed as a task
+ * on a work-stealing pool with a worker per core, printing a CSV row for each
+ * simulation as soon as it finishes, so rows arrive in no particular order.
+ * Seed s of a simulation is random_seed + s, which only matters to the random
+ * algorithms.
+ */
+void sweep(const vector<string> &traces, const vector<string> &policies, const vector<int> &frame_counts, int seeds){
+	vector<Trace> loaded(traces.size());
+
+	for (size_t t = 0; t < traces.size(); ++t){
+		loadTrace(traces[t], loaded[t]);
+	}
+
+	int per_trace = policies.size() * frame_counts.size() * seeds;
+	int tasks = traces.size() * per_trace;
+
+	int workers = std::min(tasks, std::max(1, std::min((int) thread::hardware_concurrency(), MAX_THREADS)));
+	mutex output;
+
+	cout << "trace,policy,frames,seed,faults" << endl;
+
+	if (tasks == 0){
+		return;
+	}
+
+	WorkStealingPool pool(workers, tasks);
+
+	pool.run([&](int task){
+		int t = task / per_trace;
+		int p = task % per_trace / (frame_counts.size() * seeds);
+		int n = frame_counts[task / seeds % frame_counts.size()];
+		int s = task % seeds;
+
+		string name;
+		int faults = simulate(policies[p], loaded[t], n, random_seed + s, &name);
+
+		lock_guard<mutex> guard(output);
+		cout << traces[t] << "," << name << "," << n << "," << random_seed + s << ",";
+
+		if (faults < 0){
+			cout << "unknown policy" << endl;
+		} else {
+			cout << faults << endl;
+		}
+	});
+}
+
+/*
+ * The part of a process sweep that every process writes to: the next task to
+ * hand out, and the faults of each task once it is done, or NOT_RUN
+ */
+struct SweepBoard {
+	enum { NOT_RUN = -2 };
+
+	atomic<int> next_task;
+	int tasks;
+
+	int *faults(){ return (int *) (this + 1); }
+};
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "the sweep board needs a lock-free counter to work across processes");
+
+/*
+ * The same sweep as sweep(), run by forked worker processes so that each
+ * simulation is isolated from the others and a sweep can span NUMA nodes.
+ *
+ * The reference strings are decoded once into a shared segment that is made
+ * read-only before the workers are forked, so no worker parses or copies them.
+ * Work is handed out by a lock-free counter on a shared board: each worker
+ * claims the next task with an atomic increment and writes its faults into the
+ * board's results table. A task whose worker died is reported as failed.
+ */
+void sweepProcesses(const vector<string> &traces, const vector<string> &policies, const vector<int> &frame_counts, int seeds,
+		int processes){
+	int per_trace = policies.size() * frame_counts.size() * seeds;
+	int tasks = traces.size() * per_trace;
+
+	// Lay the decoded reference strings out in the shared segment, the pages
+	// of each followed by its writes
+	vector<Trace> loaded(traces.size());
+	vector<size_t> offsets(traces.size());
+	vector<int> lengths(traces.size());
+	size_t bytes = 0;
+
+	for (size_t t = 0; t < traces.size(); ++t){
+		loadTrace(traces[t], loaded[t]);
+
+		lengths[t] = loaded[t].pages.size();
+		offsets[t] = bytes;
+		bytes += lengths[t] * (sizeof(int) + 1);
+		bytes = (bytes + sizeof(int) - 1) / sizeof(int) * sizeof(int);
+	}
+
+	size_t segment_size = std::max(bytes, (size_t) 1);
+	char *segment = (char *) mmap(NULL, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+	size_t board_size = sizeof(SweepBoard) + tasks * sizeof(int);
+	SweepBoard *board = (SweepBoard *) mmap(NULL, board_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+	if (segment == MAP_FAILED || board == MAP_FAILED){
+		cout << "Cannot map the shared sweep segments" << endl;
+		return;
+	}
+
+	for (size_t t = 0; t < traces.size(); ++t){
+		std::copy(loaded[t].pages.begin(), loaded[t].pages.end(), (int *) (segment + offsets[t]));
+		std::copy(loaded[t].writes.begin(), loaded[t].writes.end(), segment + offsets[t] + lengths[t] * sizeof(int));
+	}
+	mprotect(segment, segment_size, PROT_READ);
+
+	// The workers only see the segment
+	loaded.clear();
+
+	new (board) SweepBoard();
+	board->next_task = 0;
+	board->tasks = tasks;
+	std::fill(board->faults(), board->faults() + tasks, (int) SweepBoard::NOT_RUN);
+
+	// Anything still buffered would otherwise be printed by every worker
+	cout.flush();
+
+	int workers = std::min(processes, std::max(tasks, 1));
+	vector<pid_t> children;
+
+	for (int w = 0; w < workers; ++w){
+		pid_t child = fork();
+
+		if (child == 0){
+			for (int task = board->next_task++; task < tasks; task = board->next_task++){
+				int t = task / per_trace;
+				int p = task % per_trace / (frame_counts.size() * seeds);
+				int n = frame_counts[task / seeds % frame_counts.size()];
+				int s = task % seeds;
+
+				const int *pages = (const int *) (segment + offsets[t]);
+				const char *writes = segment + offsets[t] + lengths[t] * sizeof(int);
+
+				board->faults()[task] = simulate(policies[p], pages, writes, lengths[t], n, random_seed + s);
+			}
+			_exit(0);
+		} else if (child > 0){
+			children.push_back(child);
+		}
+	}
+
+	int failed = 0;
+
+	for (size_t w = 0; w < children.size(); ++w){
+		int status;
+		waitpid(children[w], &status, 0);
+
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+			failed++;
+		}
+	}
+
+	// The name each algorithm's engine goes by, as the threaded sweep prints.
+	// OPT-based engines are only built over a reference string, so they are
+	// given a one-reference one.
+	vector<string> names(policies.size());
+	int page = 0;
+	char write = 0;
+	for (size_t p = 0; p < policies.size(); ++p){
+		simulate(policies[p], &page, &write, 1, 1, random_seed, &names[p]);
+	}
+
+	cout << "trace,policy,frames,seed,faults" << endl;
+
+	for (int task = 0; task < tasks; ++task){
+		int t = task / per_trace;
+		int p = task % per_trace / (frame_counts.size() * seeds);
+		int n = frame_counts[task / seeds % frame_counts.size()];
+		int s = task % seeds;
+		int faults = board->faults()[task];
+
+		cout << traces[t] << "," << names[p] << "," << n << "," << random_seed + s << ",";
+
+		if (faults == SweepBoard::NOT_RUN){
+			cout << "worker failed" << endl;
+		} else if (faults < 0){
+			cout << "unknown policy" << endl;
+		} else {
+			cout << faults << endl;
+		}
+	}
+
+	if (failed > 0){
+		cout << failed << " of " << children.size() << " workers failed" << endl;
+	}
+
+	board->~SweepBoard();
+	munmap(board, board_size);
+	munmap(segment, segment_size);
+}
+
+EngineSet::EngineSet(const vector<string> &types)
+	: page_tables(types.size(), vector<int>(max_num_pages * 3)), frame_tables(types.size(), vector<int>(max_page_frames * 2)){
+	for (size_t e = 0; e < types.size(); ++e){
+		int (*pages)[3] = (int (*)[3]) &page_tables[e][0];
+		int (*frames)[2] = (int (*)[2]) &frame_tables[e][0];
+		vector<int> free_frame_list;
+
+		resetTables(pages, frames, free_frame_list);
+		Engine *engine = createEngine(types[e], pages, frames, free_frame_list);
+
+		if (engine == NULL){
+			cout << "Cannot run policy " << types[e] << " on references as they arrive" << endl;
+			continue;
+		}
+
+		names.push_back(types[e]);
+		engines.push_back(engine);
+	}
+}
+
+EngineSet::~EngineSet(){
+	for (size_t e = 0; e < engines.size(); ++e){
+		delete engines[e];
+	}
+}
+
+void EngineSet::reference(int page, int write){
+	for (size_t e = 0; e < engines.size(); ++e){
+		engines[e]->reference(page, write);
+	}
+}
+
+/*
+ * Keeps the given algorithms' engines resident and feeds them the references
+ * appended to the reference string as it grows, reading only what is new each
+ * time and printing every engine's faults after each batch. A reference is
+ * only taken once the line holding it is complete. Like tail -F, the file is
+ * followed by name: once everything written to the open file has been read, a
+ * different file under the same name (one moved over it, or recreated after
+ * it was removed) is opened and the engines go on with it from its start. A
+ * file that shrinks was truncated and is likewise read again from its start.
+ *
+ * With --checkpoint the engines are also saved after every batch, so a
+ * follower can be picked up again with --resume on the full file. Following
+ * stops after idle_polls checks in a row find nothing new, or never if it is 0.
+ */
+void followTrace(const vector<string> &types, int idle_polls){
+	EngineSet set(types);
+	vector<Engine *> &engines = set.engines;
+	vector<int> reported(engines.size(), 0);
+
+	// The open file, and its device and inode to tell whether the name still
+	// refers to it
+	int fd = -1;
+	struct stat opened;
+	off_t offset = 0;
+	string partial;
+	int references = 0;
+	int batch = 0;
+	int idle = 0;
+
+	while (idle_polls == 0 || idle < idle_polls){
+		if (fd < 0){
+			fd = open(trace_filename.c_str(), O_RDONLY);
+			if (fd >= 0 && fstat(fd, &opened) != 0){
+				close(fd);
+				fd = -1;
+			}
+		}
+
+		struct stat current;
+		off_t size = fd >= 0 && fstat(fd, &current) == 0 ? current.st_size : 0;
+
+		if (size < offset){
+			cout << trace_filename << " was truncated, following it from the start" << endl;
+			offset = 0;
+			partial.clear();
+		}
+
+		if (size == offset){
+			// Only move on to a replacement once the old file is drained
+			struct stat named;
+			if (fd >= 0 && stat(trace_filename.c_str(), &named) == 0 &&
+					(named.st_dev != opened.st_dev || named.st_ino != opened.st_ino)){
+				cout << trace_filename << " was replaced, following it from the start" << endl;
+				close(fd);
+				fd = -1;
+				offset = 0;
+				partial.clear();
+				continue;
+			}
+
+			idle++;
+			std::this_thread::sleep_for(std::chrono::milliseconds(FOLLOW_POLL_MS));
+			continue;
+		}
+		idle = 0;
+
+		string appended(size - offset, '\0');
+		ssize_t got = pread(fd, &appended[0], appended.size(), offset);
+		if (got <= 0){
+			continue;
+		}
+		appended.resize(got);
+		offset += got;
+
+		// Take the complete lines and hold on to a trailing partial one
+		partial += appended;
+		size_t end = partial.rfind('\n');
+
+		if (end == string::npos){
+			continue;
+		}
+
+		istringstream lines(partial.substr(0, end));
+		partial.erase(0, end + 1);
+
+		string referenceString;
+		int added = 0;
+
+		while (lines >> referenceString){
+			int write = 0;
+			int page = parseReference(referenceString, write);
+
+			if (page < 0 || page >= max_num_pages){
+				continue;
+			}
+
+			set.reference(page, write);
+			added++;
+		}
+
+		if (added == 0){
+			continue;
+		}
+
+		references += added;
+		batch++;
+
+		cout << "batch " << batch << ", " << references << " references:";
+		for (size_t e = 0; e < engines.size(); ++e){
+			cout << " " << engines[e]->type << " " << engines[e]->fault_rate << " (+" << engines[e]->fault_rate - reported[e] << ")";
+			reported[e] = engines[e]->fault_rate;
+		}
+		cout << endl;
+
+		if (!checkpoint_filename.empty()){
+			saveCheckpoint(checkpoint_filename, set.names, engines, references);
+		}
+	}
+
+	if (fd >= 0){
+		close(fd);
+	}
+}
+
+/*
+ * Reads exactly size bytes, returning 0 at the end of the input or on an error
+ */
+static int readFully(int fd, void *data, size_t size){
+	char *bytes = (char *) data;
+
+	while (size > 0){
+		ssize_t got = read(fd, bytes, size);
+
+		if (got < 0 && errno == EINTR){
+			continue;
+		}
+		if (got <= 0){
+			return 0;
+		}
+
+		bytes += got;
+		size -= got;
+	}
+
+	return 1;
+}
+
+static void writeFully(int fd, const string &text){
+	size_t done = 0;
+
+	while (done < text.size()){
+		ssize_t wrote = write(fd, text.data() + done, text.size() - done);
+
+		if (wrote < 0 && errno == EINTR){
+			continue;
+		}
+		if (wrote <= 0){
+			return;
+		}
+
+		done += wrote;
+	}
+}
+
+static uint32_t littleEndian32(const unsigned char *bytes){
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+/*
+ * Serves one stream of frames until it ends, answering on out. Returns 1 if
+ * the stream asked the server to stop.
+ */
+static int serveStream(EngineSet &set, long long &references, int in, int out){
+	unsigned char header[5];
+	vector<unsigned char> payload;
+
+	while (readFully(in, header, sizeof(header))){
+		char kind = header[0];
+		uint32_t count = littleEndian32(header + 1);
+
+		if (kind == 'R'){
+			if (count > SERVE_MAX_BATCH){
+				writeFully(out, "error batch too large\n");
+				return 0;
+			}
+
+			payload.resize(count * 4);
+			if (count > 0 && !readFully(in, &payload[0], payload.size())){
+				return 0;
+			}
+
+			for (uint32_t i = 0; i < count; ++i){
+				uint32_t reference = littleEndian32(&payload[i * 4]);
+				int page = reference & 0x7fffffff;
+
+				if (page < max_num_pages){
+					set.reference(page, reference >> 31);
+					references++;
 				}
+			}
+		} else if (kind == 'Q' || kind == 'S'){
+			ostringstream counters;
+			counters << "references " << references;
 
-				// Update the tables
-				page_table[reference][0] = freeframe;
-				page_table[reference][1] = VALID_BIT;
+			for (size_t e = 0; e < set.engines.size(); ++e){
+				counters << " " << set.engines[e]->type << " " << set.engines[e]->fault_rate;
+			}
+			counters << "\n";
+
+			writeFully(out, counters.str());
+
+			if (kind == 'S'){
+				return 1;
+			}
+		} else {
+			writeFully(out, "error unknown frame\n");
+			return 0;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Runs the given algorithms on references sent by another program, such as a
+ * tracer running beside the simulator, instead of on a reference string file.
+ * References arrive in frames of a one byte kind followed by a 32-bit little
+ * endian count:
+ *
+ *   'R' count, then count 32-bit little endian references: a batch of
+ *       references, each a page number with the top bit set for a write
+ *   'Q' 0: reply with a line of the references seen and each engine's faults
+ *   'S' 0: reply as for 'Q' and stop the server
+ *
+ * The source is stdin ("-"), a named pipe, which is opened again for the next
+ * writer whenever one closes it, or with socket_mode a Unix domain socket that
+ * takes one connection at a time. Replies go to stdout, or back over the
+ * connection. The engines keep their state across writers and connections.
+ */
+void serve(const vector<string> &types, string source, int socket_mode){
+	EngineSet set(types);
+	long long references = 0;
+
+	if (socket_mode){
+		int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+		struct sockaddr_un address;
+
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		strncpy(address.sun_path, source.c_str(), sizeof(address.sun_path) - 1);
+		unlink(source.c_str());
+
+		if (listener < 0 || bind(listener, (struct sockaddr *) &address, sizeof(address)) < 0 || listen(listener, 4) < 0){
+			cout << "Cannot listen on " << source << endl;
+			return;
+		}
+
+		// A client that goes away before its reply must not take the server
+		// down with it
+		signal(SIGPIPE, SIG_IGN);
+
+		int stopped = 0;
+		while (!stopped){
+			int connection = accept(listener, NULL, NULL);
+
+			if (connection < 0){
+				if (errno == EINTR){
+					continue;
+				}
+				break;
+			}
+
+			stopped = serveStream(set, references, connection, connection);
+			close(connection);
+		}
+
+		close(listener);
+		unlink(source.c_str());
+		return;
+	}
+
+	if (source == "-"){
+		serveStream(set, references, STDIN_FILENO, STDOUT_FILENO);
+		return;
+	}
+
+	struct stat status;
+	int pipe = stat(source.c_str(), &status) == 0 && S_ISFIFO(status.st_mode);
+
+	cout.flush();
+
+	for (;;){
+		int in = open(source.c_str(), O_RDONLY);
+
+		if (in < 0){
+			cout << "Cannot read " << source << endl;
+			return;
+		}
+
+		int stopped = serveStream(set, references, in, STDOUT_FILENO);
+		close(in);
+
+		if (stopped || !pipe){
+			return;
+		}
+	}
+}
+
+/*
+ * Runs an algorithm over the same in-memory reference string with every frame
+ * count from 1 to max_frames, spreading the frame counts over the cores, and
+ * reports its fault curve and every frame count where one more frame caused
+ * more faults. A stack algorithm such as LRU can never do that; FIFO can.
+ *
+ * For each anomaly it also reports the window of the reference string in which
+ * the larger memory fell furthest behind: it starts just after the point where
+ * the larger memory was furthest ahead and ends where it had lost the most
+ * ground since.
+ */
+void beladySweep(string type, const Trace &trace, int max_frames){
+	// The positions in the reference string of the faults at each frame count
+	vector<vector<int> > faults(max_frames + 1);
+	atomic<int> next_frames(1);
+	string name = type;
+
+	int workers = std::min(max_frames, std::max(1, std::min((int) thread::hardware_concurrency(), MAX_THREADS)));
+	vector<thread> threads;
+
+	for (int w = 0; w < workers; ++w){
+		threads.push_back(thread([&](){
+			vector<int> page_table(max_num_pages * 3);
+			vector<int> frame_table(max_page_frames * 2);
+			vector<int> free_frame_list;
+
+			int (*pages)[3] = (int (*)[3]) &page_table[0];
+			int (*frames)[2] = (int (*)[2]) &frame_table[0];
+
+			for (int n = next_frames++; n <= max_frames; n = next_frames++){
+				resetTables(pages, frames, free_frame_list, n);
+				Engine *engine = createEngine(type, pages, frames, free_frame_list, trace.pages.data(), trace.pages.size());
+
+				if (engine == NULL){
+					continue;
+				}
+
+				for (size_t i = 0; i < trace.pages.size(); ++i){
+					if (engine->reference(trace.pages[i], trace.writes[i])){
+						faults[n].push_back(i);
+					}
+				}
+
+				if (n == 1){
+					name = engine->type;
+				}
+				delete engine;
+			}
+		}));
+	}
+
+	for (size_t w = 0; w < threads.size(); ++w){
+		threads[w].join();
+	}
+
+	cout << name << " faults by frame count:";
+	for (int n = 1; n <= max_frames; ++n){
+		cout << " " << n << ":" << faults[n].size();
+	}
+	cout << endl;
+
+	int anomalies = 0;
+
+	for (int n = 1; n < max_frames; ++n){
+		const vector<int> &smaller = faults[n];
+		const vector<int> &larger = faults[n + 1];
+
+		if (larger.size() <= smaller.size()){
+			continue;
+		}
+
+		// Walk both lists of faults in order of position, tracking how many
+		// more faults the larger memory has taken so far
+		size_t a = 0, b = 0;
+		int excess = 0, low = 0, start = 0;
+		int peak = 0, peak_start = 0, peak_end = 0;
+
+		while (a < smaller.size() || b < larger.size()){
+			int position;
+
+			if (b < larger.size() && (a >= smaller.size() || larger[b] <= smaller[a])){
+				position = larger[b];
+				excess++;
+				if (a < smaller.size() && smaller[a] == position){
+					excess--;
+					a++;
+				}
+				b++;
+			} else {
+				position = smaller[a];
+				excess--;
+				a++;
+			}
+
+			if (excess <= low){
+				low = excess;
+				start = position + 1;
+			} else if (excess - low > peak){
+				peak = excess - low;
+				peak_start = start;
+				peak_end = position;
+			}
+		}
+
+		anomalies++;
+		cout << "Belady's anomaly: " << n << " -> " << n + 1 << " frames raised faults from " << smaller.size() << " to "
+			<< larger.size() << ", caused by references " << peak_start << " to " << peak_end;
+
+		if (peak_end - peak_start < 40){
+			cout << ":";
+			for (int i = peak_start; i <= peak_end; ++i){
+				cout << " " << trace.pages[i];
+			}
+		}
+		cout << endl;
+	}
+
+	if (anomalies == 0){
+		cout << "No anomaly: faults never rose with more frames" << endl;
+	}
+}
+
+FenwickTree::FenwickTree(int size){
+	reset(size);
+}
+
+void FenwickTree::reset(int size){
+	tree.assign(size + 1, 0);
+}
+
+void FenwickTree::add(int position, int delta){
+	for (int i = position + 1; i < (int) tree.size(); i += i & -i){
+		tree[i] += delta;
+	}
+}
+
+int FenwickTree::prefix(int position){
+	int sum = 0;
+	for (int i = position + 1; i > 0; i -= i & -i){
+		sum += tree[i];
+	}
+	return sum;
+}
+
+StackDistance::StackDistance() : marks(64), owner(64, -1), next_slot(0), distinct(0){
+}
+
+/*
+ * Moves the page to the top of the stack. Its distance is one more than the
+ * number of pages referenced since its last reference, which are exactly the
+ * marks after its slot.
+ */
+int StackDistance::reference(int page){
+	if (page >= (int) slot.size()){
+		slot.resize(std::max(page + 1, 2 * (int) slot.size()), -1);
+	}
+
+	int distance = 0;
+	int previous = slot[page];
+
+	if (previous == -1){
+		distinct++;
+	} else {
+		distance = distinct - marks.prefix(previous) + 1;
+		marks.add(previous, -1);
+		owner[previous] = -1;
+	}
+
+	if (next_slot == (int) owner.size()){
+		compact();
+	}
+
+	slot[page] = next_slot;
+	owner[next_slot] = page;
+	marks.add(next_slot++, 1);
+
+	return distance;
+}
+
+/*
+ * Renumbers the live slots from 0 in the same order, leaving as many free slots
+ * as there are distinct pages so that the next compaction is that far away
+ */
+void StackDistance::compact(){
+	vector<int> live;
+	for (int i = 0; i < next_slot; ++i){
+		if (owner[i] != -1){
+			live.push_back(owner[i]);
+		}
+	}
+
+	int size = std::max(64, 2 * (int) live.size());
+	owner.assign(size, -1);
+	marks.reset(size);
+
+	for (next_slot = 0; next_slot < (int) live.size(); ++next_slot){
+		slot[live[next_slot]] = next_slot;
+		owner[next_slot] = live[next_slot];
+		marks.add(next_slot, 1);
+	}
+}
+
+MissRatioCurve::MissRatioCurve(string type) : type(type), references(0), hits(1, 0){
+}
+
+void MissRatioCurve::add(int distance){
+	references++;
+
+	if (distance == 0){
+		return;
+	}
+
+	if (distance >= (int) hits.size()){
+		hits.resize(distance + 1, 0);
+	}
+	hits[distance]++;
+}
+
+long long MissRatioCurve::misses(int frames) const{
+	long long hit = 0;
+	for (int d = 1; d <= frames && d < (int) hits.size(); ++d){
+		hit += hits[d];
+	}
+	return references - hit;
+}
+
+/*
+ * Mattson's stack algorithm for LRU: LRU with n frames holds exactly the top n
+ * pages of the stack, so one pass over the reference string gives the faults
+ * for every number of frames at once in O(N log M) time
+ */
+MissRatioCurve lruCurve(const Trace &trace){
+	MissRatioCurve curve("LRU");
+	StackDistance stack;
+
+	for (size_t i = 0; i < trace.pages.size(); ++i){
+		curve.add(stack.reference(trace.pages[i]));
+	}
+
+	return curve;
+}
+
+/*
+ * Prints the faults and miss ratio of each curve for every number of frames up
+ * to the largest stack distance seen, past which only the first reference to
+ * each page still faults
+ */
+void printCurves(const vector<MissRatioCurve> &curves){
+	int largest = 1;
+	for (size_t c = 0; c < curves.size(); ++c){
+		largest = std::max(largest, (int) curves[c].hits.size() - 1);
+	}
+
+	cout << "Frames";
+	for (size_t c = 0; c < curves.size(); ++c){
+		cout << "\t" << curves[c].type << " faults\t" << curves[c].type << " ratio";
+	}
+	cout << endl;
+
+	vector<long long> misses(curves.size());
+	for (size_t c = 0; c < curves.size(); ++c){
+		misses[c] = curves[c].references;
+	}
+
+	for (int n = 1; n <= largest; ++n){
+		cout << n;
+		for (size_t c = 0; c < curves.size(); ++c){
+			if (n < (int) curves[c].hits.size()){
+				misses[c] -= curves[c].hits[n];
+			}
+			cout << "\t" << misses[c] << "\t" << (curves[c].references ? (double) misses[c] / curves[c].references : 0);
+		}
+		cout << endl;
+	}
+}
+
+/*
+ * The priority stack algorithm for OPT. OPT is a stack algorithm too once pages
+ * are ranked by their next reference, so OPT with n frames holds the top n pages
+ * of a stack kept in that order. The referenced page goes on top and the page
+ * it displaces is carried down: at each level the page that is needed sooner
+ * stays and the other is carried on, until the level the referenced page came
+ * from. Each reference costs its stack distance, not a scan per frame count.
+ */
+MissRatioCurve optCurve(const Trace &trace){
+	MissRatioCurve curve("OPT");
+	int references = trace.pages.size();
+
+	// When each reference's page is referenced next, or never
+	vector<int> next_use(references);
+	vector<int> seen;
+
+	for (int i = references - 1; i >= 0; --i){
+		int page = trace.pages[i];
+
+		if (page >= (int) seen.size()){
+			seen.resize(page + 1, references);
+		}
+		next_use[i] = seen[page];
+		seen[page] = i;
+	}
+
+	vector<int> stack;
+	vector<int> depth(seen.size(), -1);
+	vector<int> next_of(seen.size(), references);
+
+	for (int i = 0; i < references; ++i){
+		int page = trace.pages[i];
+		int level = depth[page];
+
+		if (level == -1){
+			level = stack.size();
+			stack.push_back(page);
+			curve.add(0);
+		} else {
+			curve.add(level + 1);
+		}
+
+		next_of[page] = next_use[i];
+
+		int carried = stack[0];
+		stack[0] = page;
+		depth[page] = 0;
+
+		if (level == 0){
+			continue;
+		}
+
+		for (int d = 1; d < level; ++d){
+			if (next_of[stack[d]] > next_of[carried]){
+				std::swap(stack[d], carried);
+				depth[stack[d]] = d;
+			}
+		}
+
+		stack[level] = carried;
+		depth[carried] = level;
+	}
+
+	return curve;
+}
+
+HyperLogLog::HyperLogLog() : registers(1 << HYPERLOGLOG_BITS, 0), sum(1 << HYPERLOGLOG_BITS), zeros(1 << HYPERLOGLOG_BITS){
+}
+
+/*
+ * The top bits of the hash pick a register, which keeps the longest run of
+ * leading zeros (plus one) seen in the rest of the hash
+ */
+void HyperLogLog::add(uint64_t hash){
+	int index = hash >> (64 - HYPERLOGLOG_BITS);
+	uint64_t rest = hash << HYPERLOGLOG_BITS;
+
+	int rank = 1;
+	while (rank <= 64 - HYPERLOGLOG_BITS && !(rest & 0x8000000000000000ULL)){
+		rest <<= 1;
+		rank++;
+	}
+
+	if (rank <= registers[index]){
+		return;
+	}
+
+	if (registers[index] == 0){
+		zeros--;
+	}
+
+	sum += ldexp(1.0, -rank) - ldexp(1.0, -registers[index]);
+	registers[index] = rank;
+}
+
+/*
+ * The harmonic mean estimate, falling back to linear counting of the empty
+ * registers while the count is small
+ */
+double HyperLogLog::estimate() const{
+	double m = registers.size();
+	double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+
+	if (estimate <= 2.5 * m && zeros > 0){
+		estimate = m * log(m / zeros);
+	}
+
+	return estimate;
+}
+
+CounterStacks::CounterStacks() : references(0), pending(0){
+}
+
+/*
+ * Starts a counter at the beginning of every interval and takes a checkpoint
+ * at its end
+ */
+void CounterStacks::reference(int page){
+	if (pending == 0){
+		counters.push_back(Counter());
+		counters.back().count = 0;
+	}
+
+	uint64_t hash = hashPage(page);
+	for (size_t c = 0; c < counters.size(); ++c){
+		counters[c].distinct.add(hash);
+	}
+
+	references++;
+	if (++pending == COUNTER_STACKS_INTERVAL){
+		checkpoint();
+	}
+}
+
+/*
+ * A reference that is new to a counter but not to the next older one was last
+ * made between the two counters' starts, so its stack distance lies between
+ * the two counts and is taken as halfway. How many such references the interval
+ * had is the difference between the two counters' growth. References that are
+ * new to the oldest counter are first references and miss at every size.
+ *
+ * The estimates are noisy, so the growth is evened out first: every page that
+ * is new to a counter is new to all the younger ones, so a counter grows by at
+ * least as much as the next older one and by no more than the interval's length.
+ */
+void CounterStacks::checkpoint(){
+	vector<double> growth(counters.size());
+
+	for (size_t c = 0; c < counters.size(); ++c){
+		double count = counters[c].distinct.estimate();
+		growth[c] = std::min((double) pending, std::max(c > 0 ? growth[c - 1] : 0.0, count - counters[c].count));
+		counters[c].count = count;
+	}
+
+	for (size_t c = 0; c < counters.size(); ++c){
+		// References repeated within the interval are new to no counter
+		double younger = c + 1 < counters.size() ? counters[c + 1].count : 0;
+		double reused = (c + 1 < counters.size() ? growth[c + 1] : pending) - growth[c];
+
+		if (reused > 0){
+			int bucket = logBucket(std::max(1, (int) ((younger + counters[c].count) / 2 + 0.5)));
+
+			if (bucket >= (int) buckets.size()){
+				buckets.resize(bucket + 1, 0);
+			}
+			buckets[bucket] += reused;
+		}
+	}
+
+	// Prune the counters that have converged with the next older one, which
+	// would report the same distances from here on
+	size_t kept = 1;
+	for (size_t c = 1; c < counters.size(); ++c){
+		if (counters[c].count < counters[kept - 1].count * (100 - COUNTER_STACKS_PRUNE_PERCENT) / 100){
+			counters[kept++] = counters[c];
+		}
+	}
+	counters.resize(kept);
+
+	pending = 0;
+}
+
+/*
+ * Values below 32 get a bucket each; past that, each power of two is split into
+ * 16 buckets, so a bucket is never more than 1/16 of its values wide
+ */
+int logBucket(int value){
+	if (value < 32){
+		return value;
+	}
+
+	int exponent = 31 - __builtin_clz(value);
+	return 32 + (exponent - 5) * 16 + ((value >> (exponent - 4)) & 15);
+}
+
+int logBucketStart(int bucket){
+	if (bucket < 32){
+		return bucket;
+	}
+
+	int exponent = (bucket - 32) / 16 + 5;
+	return (16 + (bucket - 32) % 16) << (exponent - 4);
+}
+
+/*
+ * The curve so far, counting every reference in a bucket as being at the
+ * bucket's smallest distance
+ */
+MissRatioCurve CounterStacks::curve(){
+	if (pending > 0){
+		checkpoint();
+	}
+
+	MissRatioCurve curve("CounterStacks");
+	curve.references = references;
+
+	for (size_t b = 1; b < buckets.size(); ++b){
+		int distance = logBucketStart(b);
+
+		if (distance >= (int) curve.hits.size()){
+			curve.hits.resize(distance + 1, 0);
+		}
+		curve.hits[distance] += (long long) (buckets[b] + 0.5);
+	}
+
+	return curve;
+}
 
-				frame_table[freeframe][0] = reference;
-				fault_rate++;
+MissRatioCurve counterStacksCurve(const Trace &trace){
+	CounterStacks stacks;
 
-				// Check if the user desires output
-				if (enableVerboseOutput && vb != "never"){
-					cout << "Do you want to display the page table? (YES/NO/NEVER)" << endl;
-					cin >> vb;
+	for (size_t i = 0; i < trace.pages.size(); ++i){
+		stacks.reference(trace.pages[i]);
+	}
 
-					transform(vb.begin(), vb.end(), vb.begin(), tolower);
+	return stacks.curve();
+}
 
-					if (vb == "yes" || vb == "y"){
-						displayPageTable(page_table, "OPT");
-					}
-				}
+AverageEvictionTime::AverageEvictionTime(int budget)
+	: budget(budget), time(0), references(0), reuse(1, 0), threshold(~0ULL){
+}
 
-			} else if (!isInMemory(frame_table, page_table[reference][0], reference)){
-				int freeframe = identifyPageToRemove(frame_table, reference_string);
+/*
+ * Records the time since the page was last referenced. A sampled reference
+ * stands for all the references the sampling rate at the time skipped.
+ */
+void AverageEvictionTime::reference(int page){
+	time++;
 
-				// Place the reference to this frame into the page table
-				int oldframe = page_table[reference][0];
-				int oldpage = frame_table[freeframe][0];
+	if (budget == 0){
+		if (page >= (int) last.size()){
+			last.resize(std::max(page + 1, 2 * (int) last.size()), 0);
+		}
 
-				page_table[oldpage][1] = INVALID_BIT;
+		record(last[page] ? time - last[page] : 0, 1);
+		last[page] = time;
+		return;
+	}
 
-				page_table[reference][0] = freeframe;
-				page_table[reference][1] = VALID_BIT;
-				frame_table[freeframe][0] = reference;
+	uint64_t hash = hashPage(page);
+	if (hash > threshold){
+		return;
+	}
 
-				// Push the newly available frame back onto the vector
-				free_frame_list.push_back(oldframe);
-				fault_rate++;
+	double weight = ldexp(1.0, 64) / ((double) threshold + 1);
+	map<uint64_t, long long>::iterator it = sampled.find(hash);
 
-				// Check if the user wants output
-				if (enableVerboseOutput && vb != "never"){
-					cout << "Do you want to display the page table? (YES/NO/NEVER)" << endl;
-					cin >> vb;
+	if (it != sampled.end()){
+		record(time - it->second, weight);
+		it->second = time;
+		return;
+	}
 
-					transform(vb.begin(), vb.end(), vb.begin(), tolower);
+	record(0, weight);
+	sampled[hash] = time;
 
-					if (vb == "yes" || vb == "y"){
-						displayPageTable(page_table, "OPT");
-					}
-				}
-			}
+	// Lower the threshold to just below the largest tracked hash, which drops
+	// that page, until the budget is met again
+	while ((int) sampled.size() > budget){
+		map<uint64_t, long long>::iterator largest = --sampled.end();
+		threshold = largest->first - 1;
+		sampled.erase(largest);
+	}
+}
 
-			// Remove the first element in the vector as long as there is one. There
-			// will only be one case where there are no more elements left in the vector
-			// but the method should summarily exit once this is found by having discovered
-			// that there is no more input left in the file.
-			if (reference_string.size() > 0){
-				reference_string.erase(reference_string.begin());
-			}
+/*
+ * A reuse time of 0 stands for a first reference, which misses at every size
+ */
+void AverageEvictionTime::record(long long reuse_time, double weight){
+	references += weight;
 
-		}
+	if (reuse_time == 0){
+		return;
 	}
 
-	// Display the OPT fault rate
-	cout << "OPT : " << fault_rate << endl;
-	addresses.close();
+	int bucket = budget == 0 ? reuse_time : logBucket(reuse_time);
+	if (bucket >= (int) reuse.size()){
+		reuse.resize(bucket + 1, 0);
+	}
+	reuse[bucket] += weight;
 }
 
 /*
- * A method used solely by the optimal page replacement algorithm. Given a reference string
- * and a frame table, the reference string and the frame table is compared to check which
- * currently occupied frame in the frame table will be used the farthest in time from the
- * current element. Said element will then be chosen for removal
+ * With P(t) the share of references whose reuse time is more than t, a page
+ * that entered an LRU memory of c frames is evicted on average after AET(c)
+ * references, the least T with P(0) + ... + P(T - 1) >= c, and the miss ratio
+ * is P(AET(c)). One pass over the histogram finds AET(c) for every c in order.
+ * Reuse times in a bucket are taken to be at its start.
  */
-int identifyPageToRemove(int frame_table[MAX_PAGE_FRAMES][2], vector<int> reference_string){
-    int victim = 0;
-
-	// No free frames are available, so we must use the page reference string
-	// to identify which page is going to be used last and replace it
-	int futureref[MAX_PAGE_FRAMES];
+MissRatioCurve AverageEvictionTime::curve(string type){
+	MissRatioCurve curve(type);
+	curve.references = time;
 
-	// All elements should be initialized to a positive invalid number. That way,
-	// if it is never accessed again then we can tell because it will have a high
-	// (essentially infinite) number of moves that it will require to get there
-	for (int i = 0; i < MAX_PAGE_FRAMES; ++i){
-		futureref[i] = PROC_POOL_SIZE + 100;
+	if (references == 0){
+		return curve;
 	}
 
-	// Given this element and all elements in the frame table,
-	// determine if any element in the frame table is referenced
-	// again. If it is, place the value of turns that it will take to
-	// get there into the array
-	for (int i = 0; i < MAX_PAGE_FRAMES; ++i){
-		for (int j = 0; j < reference_string.size(); j++){
-			if (reference_string.at(j) == frame_table[i][0]){
-				futureref[i] = j;
-				break;
-			}
+	// SHARDS-adj: a hot page that happens to be sampled stands for more
+	// references than it made, or a cold one for fewer, so the sampled
+	// references do not add up to the references seen. The difference is
+	// mostly reuses at the shortest times, so it is taken from (or added to)
+	// the shortest reuse times.
+	vector<double> histogram = reuse;
+	double total = references;
+
+	if (budget > 0 && histogram.size() > 1){
+		double excess = total - time;
+
+		if (excess < 0){
+			histogram[1] -= excess;
+		}
+		for (size_t b = 1; b < histogram.size() && excess > 0; ++b){
+			double taken = std::min(excess, histogram[b]);
+			histogram[b] -= taken;
+			excess -= taken;
 		}
+		total = time;
 	}
 
-	// Find the value with the largest amount of turns that it will take to
-	// get there and use that as the frame that should be freed
-	int max_turns = -1;
+	vector<double> ratio(1, 1.0);
+	double remaining = total;
 
-	for (int i = 0; i < MAX_PAGE_FRAMES; ++i){
-		if (futureref[i] > max_turns){
-			max_turns = futureref[i];
-            victim = i;
+	// P(0) is 1, so one frame is filled by t = 1
+	double area = 1;
+
+	for (size_t b = 1; b < histogram.size(); ++b){
+		long long start = budget == 0 ? b : logBucketStart(b);
+		long long end = budget == 0 ? b + 1 : logBucketStart(b + 1);
+
+		remaining -= histogram[b];
+		double p = std::max(0.0, remaining / total);
+
+		// The sizes whose eviction time is the start of this bucket
+		while (area >= ratio.size()){
+			ratio.push_back(p);
+		}
+
+		area += p * (end - start);
+
+		// And those whose eviction time falls inside it
+		while (area - p >= ratio.size()){
+			ratio.push_back(p);
 		}
 	}
 
-	return victim;
+	long long previous = time;
+	for (size_t c = 1; c < ratio.size(); ++c){
+		long long misses = std::min(previous, (long long) (ratio[c] * time + 0.5));
+
+		curve.hits.push_back(previous - misses);
+		previous = misses;
+	}
+
+	return curve;
+}
+
+MissRatioCurve aetCurve(const Trace &trace, int budget){
+	AverageEvictionTime model(budget);
+
+	for (size_t i = 0; i < trace.pages.size(); ++i){
+		model.reference(trace.pages[i]);
+	}
+
+	return model.curve(budget == 0 ? "AET" : "AET-sampled");
 }
 
 /*
- * A method that implements both the MRU and LRU page replacement algorithms, depending on the string parameter type.
+ * The same stack distances as lruCurve, computed by chunks of the reference
+ * string on separate threads in three phases:
  *
- * LRU:
- * Implement the least recently used page replacement algorithm. There is a bit that keeps track of how many pages have
- * been accessed sicne any particular page was last accessed. The algorithm decides the least recently used page by detecting
- * the largest number out of all of these bits in that column of the array.
+ *   1. Each chunk runs its own stack. A reference whose page was already
+ *      referenced in the chunk gets its exact distance; the first reference to
+ *      each page is left for later. The chunk also keeps its pages in order of
+ *      their last reference.
+ *   2. The stack as it stands at the start of each chunk is built in order:
+ *      the previous chunk's pages, most recent first, on top of the stack it
+ *      started with.
+ *   3. Each chunk resolves its first references against its incoming stack.
+ *      The pages of the incoming stack are marked in a Fenwick tree by their
+ *      position and unmarked as the chunk references them, so the distance of a
+ *      first reference is the distinct pages the chunk referenced before it
+ *      plus the marked pages above its position.
  *
- * MRU:
- * Implement the most recently used page replacement algorithm. There is a bit that keeps track of how many pages have
- * been accessed since any particular page was last accessed. The algorithm decides the most recently used page by detecting
- * the smallest number out of all of these bits in that column of the array.
+ * Phases 1 and 3 are O(N log M) split over the threads; phase 2 is O(M) per
+ * chunk.
  */
-void RU(int page_table[MAX_NUM_PAGES][3], int frame_table[MAX_PAGE_FRAMES][2], vector<int> free_frame_list, string type){
-	// Start by reading in addresses that the program would access in sequential order from the file
-	ifstream addresses;
-	addresses.open("reference_string.txt");
-
-	string referenceString;
+MissRatioCurve parallelLruCurve(const Trace &trace, int chunks){
+	int references = trace.pages.size();
+	chunks = std::max(1, std::min(chunks, references / 1024));
 
-	int reference = 0;
-	int fault_rate = 0;
+	if (chunks == 1){
+		return lruCurve(trace);
+	}
 
-	/*
-	 * Continue reading from the file only if the file is open and not at the end of its input
-	 */
-	if (addresses.is_open()){
-		while (!addresses.eof()) {
-			addresses >> referenceString;
-			reference = atoi(referenceString.c_str());
-			// If the reference to physical memory is invalid, we need to get a
-			// new page. Consult the free frame list to find a free frame on
-			// the backing store
-			if (page_table[reference][1] == INVALID_BIT){
-				int freeframe = 0;
-				fault_rate++;
+	int pages = 0;
+	for (int i = 0; i < references; ++i){
+		pages = std::max(pages, trace.pages[i] + 1);
+	}
 
-				// If we have no more free frames to allocate, then all of the
-				// slots in the frame table must be occupied.
-				if (free_frame_list.size() == 0){
-					// No free frames are available, so we must degrade to RU method of
-					// selecting a frame. Decide upon what method to use based on parameter
-					// type
-
-					// No free frames are available, so we must degrade to MRU method of
-					// selecting a frame. Select a frame whose RU bit is greatest.
-					if (type == "MRU"){
-						int k = 0;
-						int max = frame_table[k][1];
-
-						for (k = 1; k < MAX_PAGE_FRAMES; ++k){
-							if (frame_table[k][1] > max){
-								max = frame_table[k][1];
-								freeframe = k;
-							}
-						}
-					}
-					// Default to LRU if input is invalid
-					else {
-						// No free frames are available, so we must degrade to LRU method of
-						// selecting a frame. Select a frame whose the largest RU bit.
-						int k = 0;
-						int min = frame_table[k][1];
-
-						for (k = 1; k < MAX_PAGE_FRAMES; ++k){
-							if (frame_table[k][1] < min){
-								min = frame_table[k][1];
-								freeframe = k;
-							}
-						}
-					}
-				} else {
-					// Pick a free frame from the top of the list
-					freeframe = free_frame_list.back();
+	vector<int> begin(chunks + 1);
+	for (int c = 0; c <= chunks; ++c){
+		begin[c] = (long long) references * c / chunks;
+	}
 
-					// Remove this page from the free frame list and decrease the size of the
-					// list by one.
-					free_frame_list.pop_back();
-				}
+	vector<vector<long long> > hits(chunks);
+	vector<vector<int> > recent(chunks);
+	vector<vector<int> > incoming(chunks);
+	vector<thread> threads;
 
-				// Update the tables
-				page_table[reference][0] = freeframe;
-				page_table[reference][1] = VALID_BIT;
+	for (int c = 0; c < chunks; ++c){
+		threads.push_back(thread([&, c](){
+			StackDistance stack;
 
-				frame_table[freeframe][0] = reference;
+			for (int i = begin[c]; i < begin[c + 1]; ++i){
+				int distance = stack.reference(trace.pages[i]);
 
-				// Increment all the other bits to indicate how many turns have gone by without
-				// each of those pages being accessed.
-				int p;
-				for (p = 0; p < MAX_PAGE_FRAMES; ++p){
-					if (p == freeframe) continue;
+				if (distance > 0){
+					if (distance >= (int) hits[c].size()){
+						hits[c].resize(distance + 1, 0);
+					}
+					hits[c][distance]++;
+				}
+			}
 
-					frame_table[p][1] = frame_table[p][1]++;
+			for (int s = stack.next_slot - 1; s >= 0; --s){
+				if (stack.owner[s] != -1){
+					recent[c].push_back(stack.owner[s]);
 				}
+			}
+		}));
+	}
 
-				// Check if the user desires output
-				if (enableVerboseOutput && vb != "never"){
-					cout << "Do you want to display the page table? (YES/NO/NEVER)" << endl;
-					cin >> vb;
+	for (int c = 0; c < chunks; ++c){
+		threads[c].join();
+	}
+	threads.clear();
 
-					transform(vb.begin(), vb.end(), vb.begin(), tolower);
+	vector<char> moved(pages, 0);
+	for (int c = 1; c < chunks; ++c){
+		const vector<int> &top = recent[c - 1];
 
-					if (vb == "yes" || vb == "y"){
-						displayPageTable(page_table, type);
-					}
-				}
-			} else if (!isInMemory(frame_table, page_table[reference][0], reference)){
-				int freeframe = 0;
-				++fault_rate;
-
-				// No free frames are available, so we must degrade to MRU method of
-				// selecting a frame. Select a frame whose RU bit is greatest.
-				if (type == "MRU"){
-					int k = 0;
-					int max = frame_table[k][1];
-					for (k = 1; k < MAX_PAGE_FRAMES; ++k){
-						if (frame_table[k][1] > max){
-							max = frame_table[k][1];
-							freeframe = k;
-						}
-					}
-				}
-				// Default to LRU if input is invalid
-				else {
-					// No free frames are available, so we must degrade to LRU method of
-					// selecting a frame. Select a frame whose the largest RU bit.
-					int k = 0;
-					int min = frame_table[k][1];
-
-					for (k = 1; k < MAX_PAGE_FRAMES; ++k){
-						if (frame_table[k][1] < min){
-							min = frame_table[k][1];
-							freeframe = k;
-						}
-					}
-				}
+		incoming[c] = top;
+		for (size_t i = 0; i < top.size(); ++i){
+			moved[top[i]] = 1;
+		}
 
-				// Mark the old page in the page table as invalid, place the new
-				// page into its location in the page table and then update
-				// both tables
-				int oldframe = page_table[reference][0];
-				int oldpage = frame_table[freeframe][0];
+		for (size_t i = 0; i < incoming[c - 1].size(); ++i){
+			if (!moved[incoming[c - 1][i]]){
+				incoming[c].push_back(incoming[c - 1][i]);
+			}
+		}
 
-				page_table[oldpage][1] = INVALID_BIT;
+		for (size_t i = 0; i < top.size(); ++i){
+			moved[top[i]] = 0;
+		}
+	}
 
-				page_table[reference][0] = freeframe;
-				page_table[reference][1] = VALID_BIT;
-				frame_table[freeframe][0] = reference;
+	for (int c = 1; c < chunks; ++c){
+		threads.push_back(thread([&, c](){
+			const vector<int> &stack = incoming[c];
+			vector<int> position(pages, -1);
+			vector<char> seen(pages, 0);
+			FenwickTree marks(stack.size());
 
-				free_frame_list.push_back(oldframe);
+			for (size_t i = 0; i < stack.size(); ++i){
+				position[stack[i]] = i;
+				marks.add(i, 1);
+			}
 
-				// Increment all the other bits to indicate how many turns have gone by without
-				// each of those pages being accessed.
-				int p;
-				for (p = 0; p < MAX_PAGE_FRAMES; ++p){
-					if (p == freeframe) continue;
+			int distinct = 0;
 
-					frame_table[p][1] = frame_table[p][1]++;
-				}
+			for (int i = begin[c]; i < begin[c + 1]; ++i){
+				int page = trace.pages[i];
 
-				if (enableVerboseOutput && vb != "never"){
-					cout << "Do you want to display the page table? (YES/NO/NEVER)" << endl;
-					cin >> vb;
+				if (seen[page]){
+					continue;
+				}
+				seen[page] = 1;
 
-					transform(vb.begin(), vb.end(), vb.begin(), tolower);
+				if (position[page] != -1){
+					int distance = distinct + marks.prefix(position[page] - 1) + 1;
 
-					if (vb == "yes" || vb == "y"){
-						displayPageTable(page_table, type);
+					if (distance >= (int) hits[c].size()){
+						hits[c].resize(distance + 1, 0);
 					}
+					hits[c][distance]++;
+					marks.add(position[page], -1);
 				}
-
+				distinct++;
 			}
+		}));
+	}
 
-			// Otherwise, this reference was valid so reset the bit for this reference
-			// and increase the bit for all others
-			frame_table[page_table[reference][0]][1] = 0;
+	for (size_t t = 0; t < threads.size(); ++t){
+		threads[t].join();
+	}
 
-			// Increment all the other bits to indicate how many turns have gone by without
-			// each of those pages being accessed.
-			int p;
-			for (p = 0; p < MAX_PAGE_FRAMES; ++p){
-				if (p == page_table[reference][0]) continue;
+	MissRatioCurve curve("LRU");
+	curve.references = references;
 
-				frame_table[p][1] = frame_table[p][1]++;
-			}
+	for (int c = 0; c < chunks; ++c){
+		if (hits[c].size() > curve.hits.size()){
+			curve.hits.resize(hits[c].size(), 0);
+		}
+		for (size_t d = 1; d < hits[c].size(); ++d){
+			curve.hits[d] += hits[c][d];
 		}
 	}
 
-	// Display the fault rate
-	cout << type << ": " << fault_rate << endl;
-	addresses.close();
+	return curve;
 }
 
 /*
- * Performs page replacement by replacing the page that's been resident longest in the page table
+ * Folds bytes into a 64-bit FNV-1a hash
  */
-void FIFO(int page_table[MAX_NUM_PAGES][3], int frame_table[MAX_PAGE_FRAMES][2], vector<int> free_frame_list){
-	// Start by reading in addresses that the program would access in sequential order from the file
-	ifstream addresses;
-	addresses.open("reference_string.txt");
+static inline uint64_t fnv1a(uint64_t hash, const char *data, size_t length){
+	for (size_t i = 0; i < length; ++i){
+		hash = (hash ^ (unsigned char) data[i]) * 1099511628211ULL;
+	}
 
-	string referenceString;
+	return hash;
+}
 
-	int reference = 0;
-	int fault_rate = 0;
-	int FIFOSelection = MAX_PAGE_FRAMES - 1;
+/*
+ * Hashes the contents of a file, or returns 0 if it cannot be read
+ */
+static uint64_t hashFile(string filename){
+	ifstream in(filename.c_str(), std::ios::binary);
 
-	/*
-	 * Continue reading from the file only if the file is open and not at the end of its input
-	 */
-	if (addresses.is_open()){
-		while (!addresses.eof()) {
-			addresses >> referenceString;
-			reference = atoi(referenceString.c_str());
+	if (!in.is_open()){
+		return 0;
+	}
 
-			// If the reference to physical memory is invalid, we need to get a
-			// new page. Consult the free frame list to find a free frame on
-			// the backing store
-			if (page_table[reference][1] == INVALID_BIT){
-				int freeframe = 0;
+	uint64_t hash = 14695981039346656037ULL;
+	char buffer[4096];
 
-				// If we have no more free frames to allocate, then all of the
-				// slots in the frame table must be occupied.
-				if (free_frame_list.size() == 0){
-					// No free frames are available, so we must degrade to FIFO method of
-					// selecting a frame.
-					freeframe = FIFOSelection;
-					FIFOSelection--;
-
-					// If the global variable to denote the least recent frame to be
-					// placed into memory exceeds the number of pages in the page frame
-					// table, roll over to 0 and start from the top again
-					if (FIFOSelection == 0){
-						FIFOSelection = MAX_PAGE_FRAMES - 1;
-					}
-				} else {
-					// Pick a free frame from the back of the list
-					freeframe = free_frame_list.back();
+	while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0){
+		hash = fnv1a(hash, buffer, in.gcount());
+	}
 
-					// Remove this page from the free frame list and decrease the size of the
-					// list by one.
-					free_frame_list.pop_back();
-				}
+	return hash;
+}
 
-				// Mark the old page in the page table as invalid, place the new
-				// page into its location in the page table and then update
-				// both tables
-				page_table[reference][0] = freeframe;
-				page_table[reference][1] = VALID_BIT;
+/*
+ * Runs the experiment declared in a manifest, one directive per line and '#'
+ * starting a comment:
+ *
+ *   trace F G ...     reference strings to run (at least one)
+ *   policy P Q ...    algorithms, by the names createEngine() takes, which
+ *                     carry their parameters as in LRU-3 (default: FIFO, LRU,
+ *                     MRU, OPT, RAN and RAN2)
+ *   frames A-B,C,...  frame counts (default: 1 to max-frames)
+ *   max-frames N      the most frames any simulation gets (default: --frames)
+ *   pages N           the size of the page table (default: --pages)
+ *   seeds S           seeds per simulation (default: 1)
+ *   seed N            the first seed (default: 0), fixed so reruns agree
+ *   output F          the CSV file of results (default: the manifest's name
+ *                     followed by .csv)
+ *
+ * Each result row carries a hash of everything it was computed from: the
+ * contents of the reference string, the sizes of the page and frame tables
+ * (which decide which references are skipped and how far a policy can look),
+ * the algorithm, the frame count and the seed. Rows of the output whose hash
+ * still matches are kept, rows no longer declared are dropped, and only the
+ * missing simulations are run, in parallel, each appended to the output as it
+ * finishes so an interrupted run loses nothing.
+ */
+void runManifest(string filename){
+	ifstream in(filename.c_str());
 
-				frame_table[freeframe][0] = reference;
-				fault_rate++;
+	if (!in.is_open()){
+		cout << "Cannot read manifest " << filename << endl;
+		return;
+	}
 
-				if (enableVerboseOutput && vb != "never"){
-					cout << "Do you want to display the page table? (YES/NO/NEVER)" << endl;
-					cin >> vb;
+	vector<string> traces, policies;
+	vector<string> frame_lists;
+	vector<int> frame_counts;
+	int seeds = 1;
+	uint64_t first_seed = 0;
+	string output = filename + ".csv";
 
-					transform(vb.begin(), vb.end(), vb.begin(), tolower);
+	string line;
+	int number = 0;
 
-					if (vb == "yes" || vb == "y"){
-						displayPageTable(page_table, "FIFO");
-					}
-				}
-			} else if (!isInMemory(frame_table, page_table[reference][0], reference)){
-				// If the bit is valid, we must then check that the page that we want is currently
-				// resident in memory. If it is not, then we must bring it in by picking a "victim"
-				// page to replace
-				int freeframe = FIFOSelection;
-				FIFOSelection--;
-
-				// If the global variable to denote the least recent frame to be
-				// placed into memory exceeds the number of pages in the page frame
-				// table, roll over to 0 and start from the top again
-				if (FIFOSelection == 0){
-					FIFOSelection = MAX_PAGE_FRAMES - 1;
-				}
+	while (getline(in, line)){
+		++number;
+		line = line.substr(0, line.find('#'));
 
-				int oldframe = page_table[reference][0];
-				int oldpage = frame_table[freeframe][0];
+		istringstream words(line);
+		string directive, value;
 
-				if (oldpage != -1){
-					page_table[oldpage][1] = INVALID_BIT;
-				}
+		if (!(words >> directive)){
+			continue;
+		}
 
-				page_table[reference][0] = freeframe;
-				page_table[reference][1] = VALID_BIT;
-				frame_table[freeframe][0] = reference;
+		while (words >> value){
+			if (directive == "trace"){
+				traces.push_back(value);
+			} else if (directive == "policy"){
+				transform(value.begin(), value.end(), value.begin(), toupper);
+				policies.push_back(value);
+			} else if (directive == "frames"){
+				frame_lists.push_back(value);
+			} else if (directive == "pages"){
+				max_num_pages = std::max(1, atoi(value.c_str()));
+			} else if (directive == "max-frames"){
+				max_page_frames = std::max(1, atoi(value.c_str()));
+			} else if (directive == "seeds"){
+				seeds = std::max(1, atoi(value.c_str()));
+			} else if (directive == "seed"){
+				first_seed = strtoull(value.c_str(), NULL, 10);
+			} else if (directive == "output"){
+				output = value;
+			} else {
+				cout << filename << ":" << number << ": unknown directive " << directive << endl;
+				return;
+			}
+		}
+	}
 
-				frame_table[oldframe][0] = -1;
-				fault_rate++;
+	if (traces.empty()){
+		cout << filename << ": no trace declared" << endl;
+		return;
+	}
 
-				if (enableVerboseOutput && vb != "never"){
-					cout << "Do you want to display the page table? (YES/NO/NEVER)" << endl;
-					cin >> vb;
+	if (policies.empty()){
+		const char *defaults[] = { "FIFO", "LRU", "MRU", "OPT", "RAN", "RAN2" };
+		policies.assign(defaults, defaults + 6);
+	}
 
-					transform(vb.begin(), vb.end(), vb.begin(), tolower);
+	// Frame counts are read once max-frames is known, wherever it was given
+	for (size_t f = 0; f < frame_lists.size(); ++f){
+		vector<int> counts = parseFrameCounts(frame_lists[f]);
+		frame_counts.insert(frame_counts.end(), counts.begin(), counts.end());
+	}
 
-					if (vb == "yes" || vb == "y"){
-						displayPageTable(page_table, "FIFO");
-					}
+	if (frame_counts.empty()){
+		for (int n = 1; n <= max_page_frames; ++n){
+			frame_counts.push_back(n);
+		}
+	}
+
+	// Every result the manifest declares, keyed on what identifies it, with
+	// the hash of the inputs it has to have been computed from
+	vector<string> keys;
+	vector<string> hashes;
+	vector<int> cell_trace, cell_policy, cell_frames;
+	vector<uint64_t> cell_seed;
+
+	uint64_t tables = hashPage(max_num_pages ^ hashPage(max_page_frames));
+
+	for (size_t t = 0; t < traces.size(); ++t){
+		uint64_t contents = hashPage(hashFile(traces[t]) ^ tables);
+
+		for (size_t p = 0; p < policies.size(); ++p){
+			uint64_t policy_hash = fnv1a(14695981039346656037ULL, policies[p].data(), policies[p].size());
+
+			for (size_t n = 0; n < frame_counts.size(); ++n){
+				for (int s = 0; s < seeds; ++s){
+					ostringstream key, hash;
+					key << traces[t] << "," << policies[p] << "," << frame_counts[n] << "," << first_seed + s;
+					hash << std::hex << hashPage(contents ^ hashPage(policy_hash ^ hashPage(frame_counts[n] ^ hashPage(first_seed + s))));
+
+					keys.push_back(key.str());
+					hashes.push_back(hash.str());
+					cell_trace.push_back(t);
+					cell_policy.push_back(p);
+					cell_frames.push_back(frame_counts[n]);
+					cell_seed.push_back(first_seed + s);
 				}
 			}
 		}
 	}
 
-	// Display the FIFO fault rate
-	cout << "FIFO :" << fault_rate << endl;
-	addresses.close();
-}
+	// Keep the rows of the previous output that are still up to date
+	map<string, string> previous;
+	ifstream old(output.c_str());
 
-/*
- * Create a series of page reference strings that the process will access
- */
-void createReferenceString(){
-    int lcv;
-    FILE *ref = fopen("reference_string.txt", "w+");
+	while (getline(old, line)){
+		size_t faults = line.rfind(',');
+		size_t hash = faults == string::npos || faults == 0 ? string::npos : line.rfind(',', faults - 1);
 
-	fprintf(ref, "%i\n", 0);
-    lcv = 1;
+		if (hash != string::npos){
+			previous[line.substr(0, hash)] = line.substr(hash + 1);
+		}
+	}
+	old.close();
 
-    while (lcv < PROC_POOL_SIZE){
-        int randNum, reference, q;
+	ofstream results(output.c_str());
+	results << "trace,policy,frames,seed,hash,faults" << endl;
 
-        // To simulate locality, a page has a 1/5 chance of
-		// being accessed again
-        randNum = rand() % 5;
-		reference = (double) rand() / (RAND_MAX+1.0) * (MAX_NUM_PAGES);
+	vector<int> pending;
 
-		for (q = 0; q < randNum; ++q){
-			fprintf(ref, "%i\n", reference);
-			++lcv;
+	for (size_t c = 0; c < keys.size(); ++c){
+		map<string, string>::iterator row = previous.find(keys[c]);
+
+		if (row != previous.end() && row->second.compare(0, hashes[c].size() + 1, hashes[c] + ",") == 0){
+			results << keys[c] << "," << row->second << endl;
+		} else {
+			pending.push_back(c);
 		}
-    }
+	}
+	results.flush();
 
-	// Close the file pointer
-	fclose(ref);
+	vector<Trace> loaded(traces.size());
+	for (size_t t = 0; t < traces.size(); ++t){
+		loadTrace(traces[t], loaded[t]);
+	}
+
+	mutex lock;
+
+	if (!pending.empty()){
+		int workers = std::min((int) pending.size(), std::max(1, std::min((int) thread::hardware_concurrency(), MAX_THREADS)));
+		WorkStealingPool pool(workers, pending.size());
+
+		pool.run([&](int task){
+			int c = pending[task];
+			int faults = simulate(policies[cell_policy[c]], loaded[cell_trace[c]], cell_frames[c], cell_seed[c]);
+
+			lock_guard<mutex> guard(lock);
+			results << keys[c] << "," << hashes[c] << ",";
+
+			if (faults < 0){
+				results << "unknown policy" << endl;
+			} else {
+				results << faults << endl;
+			}
+		});
+	}
+
+	results.close();
+
+	cout << keys.size() - pending.size() << " results up to date, " << pending.size() << " run, written to " << output << endl;
 }